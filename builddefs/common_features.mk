@@ -579,22 +579,50 @@ ifeq ($(strip $(BACKLIGHT_ENABLE)), yes)
     endif
 endif
 
-VALID_WS2812_DRIVER_TYPES := bitbang custom i2c pwm spi vendor
-
-WS2812_DRIVER ?= bitbang
+VALID_WS2812_DRIVER_TYPES := auto bitbang custom i2c pwm spi vendor
+
+# Field <2> of candidate <1> in WS2812_AUTO_CANDIDATES
+WS2812_AUTO_FIELD = $(word $(2),$(subst :, ,$(word $(1),$(WS2812_AUTO_CANDIDATES))))
+define WS2812_AUTO_DEFS
+-DWS2812_AUTO_$(1)_TIMER=$(call WS2812_AUTO_FIELD,$(1),2) \
+-DWS2812_AUTO_$(1)_CHANNEL=$(subst N,,$(call WS2812_AUTO_FIELD,$(1),3)) \
+-DWS2812_AUTO_$(1)_COMPLEMENTARY=$(if $(findstring N,$(call WS2812_AUTO_FIELD,$(1),3)),1,0) \
+-DWS2812_AUTO_$(1)_PAL_MODE=$(call WS2812_AUTO_FIELD,$(1),4) \
+-DWS2812_AUTO_$(1)_DMA_STREAM=STM32_DMA$(subst _,_STREAM,$(call WS2812_AUTO_FIELD,$(1),5)) \
+-DWS2812_AUTO_$(1)_DMA_CHANNEL=$(call WS2812_AUTO_FIELD,$(1),6)
+endef
+
+WS2812_DRIVER ?= auto
 ifeq ($(strip $(WS2812_DRIVER_REQUIRED)), yes)
     ifeq ($(filter $(WS2812_DRIVER),$(VALID_WS2812_DRIVER_TYPES)),)
         $(call CATASTROPHIC_ERROR,Invalid WS2812_DRIVER,WS2812_DRIVER="$(WS2812_DRIVER)" is not a valid WS2812 driver)
     endif
 
+    # Timer channels able to drive the data pin; without any, auto means bitbang
+    ifeq ($(strip $(WS2812_DRIVER)), auto)
+        WS2812_AUTO_CANDIDATES := $(if $(strip $(WS2812_DI_PIN)),$(filter $(strip $(WS2812_DI_PIN)):%,$(WS2812_PWM_CANDIDATES)))
+        ifeq ($(strip $(WS2812_AUTO_CANDIDATES)),)
+            WS2812_DRIVER := bitbang
+        endif
+    endif
+
     OPT_DEFS += -DWS2812_DRIVER_$(strip $(shell echo $(WS2812_DRIVER) | tr '[:lower:]' '[:upper:]'))
 
-    SRC += ws2812_$(strip $(WS2812_DRIVER)).c
+    ifeq ($(strip $(WS2812_DRIVER)), auto)
+        # ws2812_auto.h picks the first candidate on a free timer, or falls back to bitbang
+        OPT_DEFS += $(foreach i,1 2 3,$(if $(word $(i),$(WS2812_AUTO_CANDIDATES)),$(call WS2812_AUTO_DEFS,$(i))))
+        SRC += ws2812_pwm.c ws2812_bitbang.c
+    else
+        SRC += ws2812_$(strip $(WS2812_DRIVER)).c
+    endif
 
     ifeq ($(strip $(PLATFORM)), CHIBIOS)
-        ifeq ($(strip $(WS2812_DRIVER)), pwm)
+        ifneq ($(filter $(WS2812_DRIVER),auto pwm),)
             OPT_DEFS += -DSTM32_DMA_REQUIRED=TRUE
         endif
+        ifneq ($(filter $(WS2812_DRIVER),auto bitbang pwm spi),)
+            SRC += ws2812_chain.c
+        endif
     endif
 
     # add extra deps
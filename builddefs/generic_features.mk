@@ -18,6 +18,7 @@ GRAVE_ESC_ENABLE ?= yes
 
 GENERIC_FEATURES = \
     AUTOCORRECT \
+    BASIC_PROFILING \
     CAPS_WORD \
     COMBO \
     COMMAND \
@@ -30,6 +31,7 @@ GENERIC_FEATURES = \
     HAPTIC \
     KEY_LOCK \
     KEY_OVERRIDE \
+    LATENCY_TRACE \
     LEADER \
     PROGRAMMABLE_BUTTON \
     REPEAT_KEY \
@@ -9,6 +9,8 @@ BUILD_OPTION_NAMES = \
   DEBOUNCE_TYPE \
   SPLIT_KEYBOARD \
   DYNAMIC_KEYMAP_ENABLE \
+  LATENCY_TRACE_ENABLE \
+  BASIC_PROFILING_ENABLE \
   USB_HID_ENABLE \
   VIA_ENABLE
 
@@ -18,6 +18,7 @@
 #include "is31fl3736.h"
 #include "i2c_master.h"
 #include "wait.h"
+#include "atomic_util.h"
 
 // This is a 7-bit address, that gets left-shifted and bit 0
 // set to 0 for write, 1 for read (as per I2C protocol)
@@ -77,7 +78,8 @@ uint8_t g_twi_transfer_buffer[20];
 // buffers and the transfers in is31fl3736_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
 uint8_t g_pwm_buffer[DRIVER_COUNT][192];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+// One bit per 16 byte chunk of g_pwm_buffer, only those chunks are transferred.
+uint16_t g_pwm_buffer_update_required[DRIVER_COUNT] = {0};
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24] = {{0}, {0}};
 bool    g_led_control_registers_update_required   = false;
@@ -95,6 +97,23 @@ void is31fl3736_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
+static bool is31fl3736_write_pwm_chunk(uint8_t addr, uint8_t *pwm_buffer, uint8_t offset) {
+    g_twi_transfer_buffer[0] = offset;
+    // copy the data from offset to offset+15
+    // device will auto-increment register for data after the first byte
+    // thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer
+    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + offset, 16);
+
+#if ISSI_PERSISTENCE > 0
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) return true;
+    }
+    return false;
+#else
+    return i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0;
+#endif
+}
+
 void is31fl3736_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
     // assumes PG1 is already selected
 
@@ -103,19 +122,7 @@ void is31fl3736_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
 
     // iterate over the pwm_buffer contents at 16 byte intervals
     for (int i = 0; i < 192; i += 16) {
-        g_twi_transfer_buffer[0] = i;
-        // copy the data from i to i+15
-        // device will auto-increment register for data after the first byte
-        // thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer
-        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + i, 16);
-
-#if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
-        }
-#else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
-#endif
+        is31fl3736_write_pwm_chunk(addr, pwm_buffer, i);
     }
 }
 
@@ -172,10 +179,12 @@ void is31fl3736_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
         if (g_pwm_buffer[led.driver][led.r] == red && g_pwm_buffer[led.driver][led.g] == green && g_pwm_buffer[led.driver][led.b] == blue) {
             return;
         }
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        g_pwm_buffer[led.driver][led.r] = red;
+        g_pwm_buffer[led.driver][led.g] = green;
+        g_pwm_buffer[led.driver][led.b] = blue;
+        ATOMIC_BLOCK_FORCEON {
+            g_pwm_buffer_update_required[led.driver] |= (1 << (led.r / 16)) | (1 << (led.g / 16)) | (1 << (led.b / 16));
+        }
     }
 }
 
@@ -233,9 +242,11 @@ void is31fl3736_mono_set_brightness(int index, uint8_t value) {
     if (index >= 0 && index < 96) {
         // Index in range 0..95 -> A1..A8, B1..B8, etc.
         // Map index 0..95 to registers 0x00..0xBE (interleaved)
-        uint8_t pwm_register            = index * 2;
-        g_pwm_buffer[0][pwm_register]   = value;
-        g_pwm_buffer_update_required[0] = true;
+        uint8_t pwm_register          = index * 2;
+        g_pwm_buffer[0][pwm_register] = value;
+        ATOMIC_BLOCK_FORCEON {
+            g_pwm_buffer_update_required[0] |= (1 << (pwm_register / 16));
+        }
     }
 }
 
@@ -264,14 +275,28 @@ void is31fl3736_mono_set_led_control_register(uint8_t index, bool enabled) {
 }
 
 void is31fl3736_update_pwm_buffers(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
+    // take the changed chunks before sending them, chunks changed while they are
+    // being sent (e.g. with RGB_MATRIX_ASYNC_FLUSH) are sent on the next update
+    uint16_t update_required;
+    ATOMIC_BLOCK_FORCEON {
+        update_required                     = g_pwm_buffer_update_required[index];
+        g_pwm_buffer_update_required[index] = 0;
+    }
+
+    if (update_required) {
         // Firstly we need to unlock the command register and select PG1
         is31fl3736_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
         is31fl3736_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
-        is31fl3736_write_pwm_buffer(addr, g_pwm_buffer[index]);
+        // only transfer the 16 byte chunks that changed, the ones that fail are retried next time
+        for (uint8_t i = 0; i < 192 / 16; i++) {
+            if ((update_required & (1 << i)) && !is31fl3736_write_pwm_chunk(addr, g_pwm_buffer[index], i * 16)) {
+                ATOMIC_BLOCK_FORCEON {
+                    g_pwm_buffer_update_required[index] |= 1 << i;
+                }
+            }
+        }
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void is31fl3736_update_led_control_registers(uint8_t addr1, uint8_t addr2) {
@@ -23,6 +23,7 @@
 #include <string.h>
 #include "i2c_master.h"
 #include "progmem.h"
+#include "atomic_util.h"
 
 // This is a 7-bit address, that gets left-shifted and bit 0
 // set to 0 for write, 1 for read (as per I2C protocol)
@@ -75,6 +76,12 @@
 
 #define ISSI_MAX_LEDS 351
 
+// PG0 holds the first 180 PWM registers, PG1 the remaining 171.
+// They are sent in 18 byte chunks, the last one only has 9 bytes.
+#define ISSI_PWM_PAGE_SIZE 180
+#define ISSI_PWM_CHUNK_SIZE 18
+#define ISSI_PWM_CHUNK_COUNT ((ISSI_MAX_LEDS + ISSI_PWM_CHUNK_SIZE - 1) / ISSI_PWM_CHUNK_SIZE)
+
 // Transfer buffer for TWITransmitData()
 uint8_t g_twi_transfer_buffer[20] = {0xFF};
 
@@ -84,9 +91,9 @@ uint8_t g_twi_transfer_buffer[20] = {0xFF};
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in is31fl3741_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT]        = {false};
-bool    g_scaling_registers_update_required[DRIVER_COUNT] = {false};
+uint8_t  g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
+uint32_t g_pwm_buffer_update_required[DRIVER_COUNT]        = {0};
+bool     g_scaling_registers_update_required[DRIVER_COUNT] = {false};
 
 uint8_t g_scaling_registers[DRIVER_COUNT][ISSI_MAX_LEDS];
 
@@ -103,47 +110,42 @@ void is31fl3741_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
-bool is31fl3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
-    // Assume PG0 is already selected
+static void is31fl3741_select_page(uint8_t addr, uint8_t page) {
+    // unlock the command register and select the page
+    is31fl3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
+    is31fl3741_write_register(addr, ISSI_COMMANDREGISTER, page);
+}
 
-    for (int i = 0; i < 342; i += 18) {
-        if (i == 180) {
-            // unlock the command register and select PG1
-            is31fl3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-            is31fl3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM1);
-        }
+static bool is31fl3741_write_pwm_chunk(uint8_t addr, uint8_t *pwm_buffer, uint8_t chunk) {
+    // Assume the page holding the chunk is already selected
+    uint16_t offset = chunk * ISSI_PWM_CHUNK_SIZE;
+    uint8_t  size   = ISSI_MAX_LEDS - offset < ISSI_PWM_CHUNK_SIZE ? ISSI_MAX_LEDS - offset : ISSI_PWM_CHUNK_SIZE;
 
-        g_twi_transfer_buffer[0] = i % 180;
-        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + i, 18);
+    g_twi_transfer_buffer[0] = offset % ISSI_PWM_PAGE_SIZE;
+    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + offset, size);
 
 #if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
-                return false;
-            }
-        }
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, size + 1, ISSI_TIMEOUT) == 0) return true;
+    }
+    return false;
 #else
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
-            return false;
-        }
+    return i2c_transmit(addr << 1, g_twi_transfer_buffer, size + 1, ISSI_TIMEOUT) == 0;
 #endif
-    }
+}
 
-    // transfer the left cause the total number is 351
-    g_twi_transfer_buffer[0] = 162;
-    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + 342, 9);
+bool is31fl3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // Assume PG0 is already selected
 
-#if ISSI_PERSISTENCE > 0
-    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
+    for (uint8_t i = 0; i < ISSI_PWM_CHUNK_COUNT; i++) {
+        if (i * ISSI_PWM_CHUNK_SIZE == ISSI_PWM_PAGE_SIZE) {
+            is31fl3741_select_page(addr, ISSI_PAGE_PWM1);
+        }
+
+        if (!is31fl3741_write_pwm_chunk(addr, pwm_buffer, i)) {
             return false;
         }
     }
-#else
-    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
-        return false;
-    }
-#endif
 
     return true;
 }
@@ -183,10 +185,7 @@ void is31fl3741_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
         if (g_pwm_buffer[led.driver][led.r] == red && g_pwm_buffer[led.driver][led.g] == green && g_pwm_buffer[led.driver][led.b] == blue) {
             return;
         }
-        g_pwm_buffer_update_required[led.driver] = true;
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
+        is31fl3741_set_pwm_buffer(&led, red, green, blue);
     }
 }
 
@@ -222,15 +221,35 @@ void is31fl3741_set_led_control_register(uint8_t index, bool red, bool green, bo
 }
 
 void is31fl3741_update_pwm_buffers(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
-        // unlock the command register and select PG2
-        is31fl3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-        is31fl3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM0);
-
-        is31fl3741_write_pwm_buffer(addr, g_pwm_buffer[index]);
+    // Take the changed chunks before sending them, chunks changed while they are
+    // being sent (e.g. with RGB_MATRIX_ASYNC_FLUSH) are sent on the next update.
+    uint32_t update_required;
+    ATOMIC_BLOCK_FORCEON {
+        update_required                     = g_pwm_buffer_update_required[index];
+        g_pwm_buffer_update_required[index] = 0;
     }
 
-    g_pwm_buffer_update_required[index] = false;
+    // Only transfer the 18 byte chunks that changed, and only select PG1 when
+    // one of its chunks changed. The chunks that fail are retried next time.
+    uint8_t page = ISSI_PAGE_FUNCTION; // neither PWM page is selected yet
+    for (uint8_t i = 0; i < ISSI_PWM_CHUNK_COUNT; i++) {
+        if (!(update_required & (1UL << i))) {
+            continue;
+        }
+
+        uint8_t chunk_page = i * ISSI_PWM_CHUNK_SIZE < ISSI_PWM_PAGE_SIZE ? ISSI_PAGE_PWM0 : ISSI_PAGE_PWM1;
+        if (page != chunk_page) {
+            is31fl3741_select_page(addr, chunk_page);
+            page = chunk_page;
+        }
+
+        if (!is31fl3741_write_pwm_chunk(addr, g_pwm_buffer[index], i)) {
+            ATOMIC_BLOCK_FORCEON {
+                g_pwm_buffer_update_required[index] |= update_required & ~((1UL << i) - 1);
+            }
+            break;
+        }
+    }
 }
 
 void is31fl3741_set_pwm_buffer(const is31_led *pled, uint8_t red, uint8_t green, uint8_t blue) {
@@ -238,7 +257,9 @@ void is31fl3741_set_pwm_buffer(const is31_led *pled, uint8_t red, uint8_t green,
     g_pwm_buffer[pled->driver][pled->g] = green;
     g_pwm_buffer[pled->driver][pled->b] = blue;
 
-    g_pwm_buffer_update_required[pled->driver] = true;
+    ATOMIC_BLOCK_FORCEON {
+        g_pwm_buffer_update_required[pled->driver] |= (1UL << (pled->r / ISSI_PWM_CHUNK_SIZE)) | (1UL << (pled->g / ISSI_PWM_CHUNK_SIZE)) | (1UL << (pled->b / ISSI_PWM_CHUNK_SIZE));
+    }
 }
 
 void is31fl3741_update_led_control_registers(uint8_t addr, uint8_t index) {
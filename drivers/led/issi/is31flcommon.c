@@ -21,6 +21,7 @@
 #include "is31flcommon.h"
 #include "i2c_master.h"
 #include "wait.h"
+#include "atomic_util.h"
 #include <string.h>
 
 // Set defaults for Timeout and Persistence
@@ -31,13 +32,19 @@
 #    define ISSI_PERSISTENCE 0
 #endif
 
+// The PWM registers are sent in ISSI_PWM_TRF_SIZE chunks, each bit of
+// g_pwm_buffer_update_required marks a chunk that needs to be sent
+#define ISSI_PWM_CHUNK_COUNT (ISSI_MAX_LEDS / ISSI_PWM_TRF_SIZE)
+_Static_assert(ISSI_MAX_LEDS % ISSI_PWM_TRF_SIZE == 0, "ISSI_MAX_LEDS must be a multiple of ISSI_PWM_TRF_SIZE");
+_Static_assert(ISSI_PWM_CHUNK_COUNT <= 16, "Too many PWM chunks for g_pwm_buffer_update_required");
+
 // Transfer buffer for TWITransmitData()
 uint8_t g_twi_transfer_buffer[20];
 
 // These buffers match the PWM & scaling registers.
 // Storing them like this is optimal for I2C transfers to the registers.
-uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+uint8_t  g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
+uint16_t g_pwm_buffer_update_required[DRIVER_COUNT] = {0};
 
 uint8_t g_scaling_buffer[DRIVER_COUNT][ISSI_SCALING_SIZE];
 bool    g_scaling_buffer_update_required[DRIVER_COUNT] = {false};
@@ -121,13 +128,26 @@ void IS31FL_common_init(uint8_t addr, uint8_t ssr) {
 }
 
 void IS31FL_common_update_pwm_register(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
+    // Take the changed chunks before sending them, chunks changed while they are
+    // being sent (e.g. with RGB_MATRIX_ASYNC_FLUSH) are sent on the next update
+    uint16_t update_required;
+    ATOMIC_BLOCK_FORCEON {
+        update_required                     = g_pwm_buffer_update_required[index];
+        g_pwm_buffer_update_required[index] = 0;
+    }
+
+    if (update_required) {
         // Queue up the correct page
         IS31FL_unlock_register(addr, ISSI_PAGE_PWM);
-        // Hand off the update to IS31FL_write_multi_registers
-        IS31FL_write_multi_registers(addr, g_pwm_buffer[index], ISSI_MAX_LEDS, ISSI_PWM_TRF_SIZE, ISSI_PWM_REG_1ST);
-        // Update flags that pwm_buffer has been updated
-        g_pwm_buffer_update_required[index] = false;
+        // Hand off each changed chunk to IS31FL_write_multi_registers, the ones that fail are retried next time
+        for (uint8_t i = 0; i < ISSI_PWM_CHUNK_COUNT; i++) {
+            uint8_t offset = i * ISSI_PWM_TRF_SIZE;
+            if ((update_required & (1 << i)) && !IS31FL_write_multi_registers(addr, g_pwm_buffer[index] + offset, ISSI_PWM_TRF_SIZE, ISSI_PWM_TRF_SIZE, ISSI_PWM_REG_1ST + offset)) {
+                ATOMIC_BLOCK_FORCEON {
+                    g_pwm_buffer_update_required[index] |= 1 << i;
+                }
+            }
+        }
     }
 }
 
@@ -181,10 +201,15 @@ void IS31FL_RGB_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
         is31_led led;
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        if (g_pwm_buffer[led.driver][led.r] == red && g_pwm_buffer[led.driver][led.g] == green && g_pwm_buffer[led.driver][led.b] == blue) {
+            return;
+        }
+        g_pwm_buffer[led.driver][led.r] = red;
+        g_pwm_buffer[led.driver][led.g] = green;
+        g_pwm_buffer[led.driver][led.b] = blue;
+        ATOMIC_BLOCK_FORCEON {
+            g_pwm_buffer_update_required[led.driver] |= (1 << (led.r / ISSI_PWM_TRF_SIZE)) | (1 << (led.g / ISSI_PWM_TRF_SIZE)) | (1 << (led.b / ISSI_PWM_TRF_SIZE));
+        }
     }
 }
 
@@ -234,8 +259,13 @@ void IS31FL_simple_set_brightness(int index, uint8_t value) {
         is31_led led;
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
+        if (g_pwm_buffer[led.driver][led.v] == value) {
+            return;
+        }
         g_pwm_buffer[led.driver][led.v] = value;
-        g_pwm_buffer_update_required[led.driver] = true;
+        ATOMIC_BLOCK_FORCEON {
+            g_pwm_buffer_update_required[led.driver] |= 1 << (led.v / ISSI_PWM_TRF_SIZE);
+        }
     }
 }
 
@@ -28,6 +28,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define NRF_BOOT_PIN                B5
 #define NRF_WAKEUP_PIN              C4
 
+#define RF_DEVICE_NAME              "NuPhy Air60 V2-"
+#define RF_LINK_RESET_DELAY         300
+
 #define RGB_DRIVER_SDB1             C6
 #define RGB_DRIVER_SDB2             C7
 
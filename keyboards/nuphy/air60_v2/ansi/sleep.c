@@ -16,6 +16,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "ansi.h"
+#include "rf.h"
 #include "hal_usb.h"
 #include "usb_main.h"
 
@@ -24,10 +25,6 @@ extern DEV_INFO_STRUCT  dev_info;
 extern uint16_t         rf_linking_time;
 extern uint16_t         no_act_time;
 
-extern bool             f_wakeup_prepare;
-extern bool             f_goto_sleep;
-
-uint8_t uart_send_cmd(uint8_t cmd, uint8_t ack_cnt, uint8_t delayms);
 
 
 /**
@@ -16,6 +16,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "ansi.h"
+#include "rf.h"
 #include "usb_main.h"
 
 user_config_t user_config;
@@ -46,23 +47,13 @@ uint16_t rgb_test_press_delay        = 0;
 uint8_t        host_mode             = 0;
 host_driver_t *m_host_driver         = 0;
 
-extern bool               f_rf_new_adv_ok;
 extern report_keyboard_t *keyboard_report;
-extern uint8_t            bitkb_report_buf[32];
-extern uint8_t            bytekb_report_buf[8];
 extern uint8_t            side_mode;
 extern uint8_t            side_light;
 extern uint8_t            side_speed;
 extern uint8_t            side_rgb;
 extern uint8_t            side_colour;
 
-void    dev_sts_sync(void);
-void    rf_uart_init(void);
-void    rf_device_init(void);
-void    uart_send_report_func(void);
-void    uart_receive_pro(void);
-uint8_t uart_send_cmd(uint8_t cmd, uint8_t ack_cnt, uint8_t delayms);
-void    uart_send_report(uint8_t report_type, uint8_t *report_buf, uint8_t report_size);
 void    side_speed_contol(uint8_t dir);
 void    side_light_contol(uint8_t dir);
 void    side_colour_control(uint8_t dir);
@@ -102,6 +93,13 @@ void gpio_init(void) {
     writePinHigh(DC_BOOST_PIN);
 }
 
+/**
+ * @brief  Clear the paired devices once the RF module has switched link.
+ */
+static void device_reset_link_done(uint8_t cmd, bool acked) {
+    uart_send_cmd(CMD_CLR_DEVICE, 10, 500);
+}
+
 /**
  * @brief  long press key process.
  */
@@ -121,13 +119,7 @@ void long_press_key(void) {
             dev_info.rf_channel  = rf_sw_temp;
             dev_info.ble_channel = rf_sw_temp;
 
-            uint8_t timeout = 5;
-            while (timeout--) {
-                uart_send_cmd(CMD_NEW_ADV, 0, 1);
-                wait_ms(20);
-                uart_receive_pro();
-                if (f_rf_new_adv_ok) break;
-            }
+            rf_cmd_request(CMD_NEW_ADV, &f_rf_new_adv_ok, 5, 20, 1, NULL);
         }
     } else {
         rf_sw_press_delay = 0;
@@ -150,9 +142,7 @@ void long_press_key(void) {
                 dev_info.rf_channel  = LINK_BT_1;
             }
 
-            uart_send_cmd(CMD_SET_LINK, 10, 10);
-            wait_ms(500);
-            uart_send_cmd(CMD_CLR_DEVICE, 10, 10);
+            rf_cmd_request(CMD_SET_LINK, &f_uart_ack, 1, 10, 10, device_reset_link_done);
 
             void device_reset_show(void);
             void device_reset_init(void);
@@ -216,8 +206,7 @@ void break_all_key(void) {
         wait_ms(10);
     }
 
-    memset(bitkb_report_buf, 0, sizeof(bitkb_report_buf));
-    memset(bytekb_report_buf, 0, sizeof(bytekb_report_buf));
+    uart_send_report_reset();
 }
 
 /**
@@ -233,6 +222,7 @@ void switch_dev_link(uint8_t mode) {
 
     dev_info.rf_state = RF_IDLE;
     f_send_channel    = 1;
+    rf_link_kick();
 
     if (mode == LINK_USB) {
         host_mode = HOST_USB_TYPE;
@@ -241,7 +231,7 @@ void switch_dev_link(uint8_t mode) {
     } else {
         host_mode = HOST_RF_TYPE;
 
-        host_set_driver(0);
+        host_set_driver(&rf_host_driver);
     }
 }
 
@@ -314,7 +304,7 @@ void dial_sw_scan(void) {
         f_first           = false;
 
         if (dev_info.link_mode != LINK_USB) {
-            host_set_driver(0);
+            host_set_driver(&rf_host_driver);
         }
     }
 }
@@ -702,6 +692,7 @@ void keyboard_post_init_user(void) {
     rf_uart_init();
     wait_ms(500);
     rf_device_init();
+    rf_link_start();
 
     break_all_key();
     dial_sw_fast_scan();
@@ -716,7 +707,7 @@ void housekeeping_task_user(void) {
 
     uart_send_report_func();
 
-    dev_sts_sync();
+    rf_tx_task();
 
     long_press_key();
 
@@ -23,10 +23,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define NRF_RESET_PIN                       B4
 #define NRF_TEST_PIN                        B5
 #define NRF_WAKEUP_PIN                      B8
+#define RF_DEVICE_NAME                      "NuPhy Air75 V2-"
+
 #define DRIVER_LED_CS_PIN                   C6
 
 #define DRIVER_SIDE_PIN                     C8
 #define DRIVER_SIDE_CS_PIN                  C9
+#define SIDE_WS2812_PWM_DRIVER              PWMD3
+#define SIDE_WS2812_PWM_CHANNEL             3
+#define SIDE_WS2812_PWM_PAL_MODE            0
+#define SIDE_WS2812_DMA_STREAM              STM32_DMA1_STREAM3
+#define SIDE_WS2812_LED_COUNT               12
 
 #define SERIAL_DRIVER                       SD1
 #define SD1_TX_PIN                          B6
@@ -34,6 +41,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define SD1_RX_PIN                          B7
 #define SD1_RX_PAL_MODE                     0
 
+#define MATRIX_PORT_SCAN
+
 #define TAP_CODE_DELAY                      8
 #define DYNAMIC_KEYMAP_MACRO_DELAY          8
 #define DYNAMIC_KEYMAP_LAYER_COUNT          8
@@ -21,3 +21,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #undef HAL_USE_SERIAL
 #define HAL_USE_SERIAL TRUE
+
+#undef HAL_USE_PWM
+#define HAL_USE_PWM TRUE
@@ -1,3 +1,5 @@
+VPATH += keyboards/nuphy/common
+
 SRC += side.c
 SRC += rf.c
 SRC += sleep.c
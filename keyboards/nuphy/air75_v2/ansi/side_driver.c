@@ -15,92 +15,75 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <ch.h>
-#include <hal.h>
-
 #include "quantum.h"
-#include "ws2812.h"
-
-/* Adapted from https://github.com/bigjosh/SimpleNeoPixelDemo/ */
+#include "ws2812_chain.h"
 
-#ifndef NOP_FUDGE
-#if defined(STM32F0XX) || defined(STM32F1XX) || defined(GD32VF103) || defined(STM32F3XX) || defined(STM32F4XX) || defined(STM32L0XX) || defined(WB32F3G71xx) || defined(WB32FQ95xx)
-#define NOP_FUDGE 0.4
-#else
-#error("NOP_FUDGE configuration required")
-#define NOP_FUDGE 1  // this just pleases the compile so the above error is easier to spot
+/*
+ * Side light strip, a second WS2812 chain next to the matrix one. It is driven
+ * by the same WS2812_DRIVER: with the PWM driver a timer channel on
+ * DRIVER_SIDE_PIN and a circular DMA stream send the frame without any CPU
+ * time, otherwise the strip is bitbanged like the matrix.
+ */
+
+#ifndef SIDE_WS2812_PWM_DRIVER
+#define SIDE_WS2812_PWM_DRIVER      PWMD3                   // TIM3
 #endif
+#ifndef SIDE_WS2812_PWM_CHANNEL
+#define SIDE_WS2812_PWM_CHANNEL     3                       // TIM3_CH3 on PC8
 #endif
-
-// Push Pull or Open Drain Configuration
-// Default Push Pull
-#ifndef WS2812_EXTERNAL_PULLUP
-#define WS2812_OUTPUT_MODE PAL_MODE_OUTPUT_PUSHPULL
-#else
-#define WS2812_OUTPUT_MODE PAL_MODE_OUTPUT_OPENDRAIN
+#ifndef SIDE_WS2812_PWM_PAL_MODE
+#define SIDE_WS2812_PWM_PAL_MODE    0                       // PC8 alternate function for TIM3_CH3
 #endif
-
-// The reset gap can be 6000 ns, but depending on the LED strip it may have to be increased
-// to values like 600000 ns. If it is too small, the pixels will show nothing most of the time.
-#ifndef WS2812_RES
-#define WS2812_RES (1000 * WS2812_TRST_US)  // Width of the low gap between bits to cause a frame to latch
+#ifndef SIDE_WS2812_DMA_STREAM
+#define SIDE_WS2812_DMA_STREAM      STM32_DMA1_STREAM3      // DMA stream for TIM3_UP
+#endif
+#ifndef SIDE_WS2812_DMA_CHANNEL
+#define SIDE_WS2812_DMA_CHANNEL     0                       // DMA channel for TIM3_UP, unused on STM32F0
+#endif
+#ifndef SIDE_WS2812_LED_COUNT
+#define SIDE_WS2812_LED_COUNT       12
 #endif
 
-#define NUMBER_NOPS     6
-#define CYCLES_PER_SEC  (CPU_CLOCK / NUMBER_NOPS * NOP_FUDGE)
-#define NS_PER_SEC      (1000000000L)  // Note that this has to be SIGNED since we want to be able to check for negative values of derivatives
-#define NS_PER_CYCLE    (NS_PER_SEC / CYCLES_PER_SEC)
-#define NS_TO_CYCLES(n) ((n) / NS_PER_CYCLE)
+#if defined(WS2812_DRIVER_SPI)
+#error "Side WS2812 strip: no SPI peripheral on DRIVER_SIDE_PIN, use the pwm or bitbang driver"
+#endif
 
-#define wait_ns(x)                                  \
-    do {                                            \
-        for (int i = 0; i < NS_TO_CYCLES(x); i++) { \
-            __asm__ volatile(                       \
-                "nop\n\t"                           \
-                "nop\n\t"                           \
-                "nop\n\t"                           \
-                "nop\n\t"                           \
-                "nop\n\t"                           \
-                "nop\n\t");                         \
-        }                                           \
-    } while (0)
+static LED_TYPE side_leds[SIDE_WS2812_LED_COUNT];
+#if defined(WS2812_DRIVER_PWM)
+static ws2812_buffer_t side_frame_buffer[WS2812_CHAIN_BUFFER_SIZE(SIDE_WS2812_LED_COUNT)];
+#endif
 
-void side_sendByte(uint8_t byte)
-{
-    // WS2812 protocol wants most significant bits first
-    for (unsigned char bit = 0; bit < 8; bit++) {
-        bool is_one = byte & (1 << (7 - bit));
-        // using something like wait_ns(is_one ? T1L : T0L) here throws off timings
-        if (is_one) {
-            // 1
-            writePinHigh(DRIVER_SIDE_PIN);
-            wait_ns(WS2812_T1H);
-            writePinLow(DRIVER_SIDE_PIN);
-            wait_ns(WS2812_T1L);
-        } else {
-            // 0
-            writePinHigh(DRIVER_SIDE_PIN);
-            wait_ns(WS2812_T0H);
-            writePinLow(DRIVER_SIDE_PIN);
-            wait_ns(WS2812_T0L);
-        }
-    }
-}
+static ws2812_chain_t side_chain = {
+    .pin         = DRIVER_SIDE_PIN,
+    .led_count   = SIDE_WS2812_LED_COUNT,
+    .leds        = side_leds,
+#if defined(WS2812_DRIVER_PWM)
+    .pwm_driver  = &SIDE_WS2812_PWM_DRIVER,
+    .pwm_channel = SIDE_WS2812_PWM_CHANNEL,
+    .pal_mode    = SIDE_WS2812_PWM_PAL_MODE,
+    .dma_stream  = SIDE_WS2812_DMA_STREAM,
+    .dma_channel = SIDE_WS2812_DMA_CHANNEL,
+    .buffer      = side_frame_buffer,
+#endif
+};
 
 // Setleds for standard RGB
 void side_ws2812_setleds(LED_TYPE *ledarray, uint16_t leds)
 {
-    // this code is very time dependent, so we need to disable interrupts
-    chSysLock();
+    if (leds > SIDE_WS2812_LED_COUNT) leds = SIDE_WS2812_LED_COUNT;
 
-    for (uint8_t i = 0; i < leds; i++) {
-        // WS2812 protocol dictates grb order
-        side_sendByte(ledarray[i].g);
-        side_sendByte(ledarray[i].r);
-        side_sendByte(ledarray[i].b);
+    for (uint16_t i = 0; i < leds; i++) {
+        ws2812_chain_set_color(&side_chain, i, ledarray[i].r, ledarray[i].g, ledarray[i].b);
     }
 
-    wait_ns(WS2812_RES);
+    // Nothing is sent while the colors stay the same
+    ws2812_chain_flush(&side_chain);
+}
 
-    chSysUnlock();
+/**
+ * @brief  Send the whole strip with the next refresh, e.g. after the LEDs lost power.
+ */
+void side_ws2812_invalidate(void)
+{
+    side_chain.dirty = true;
 }
@@ -16,17 +16,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "ansi.h"
+#include "rf.h"
 #include "hal_usb.h"
 #include "usb_main.h"
 
 extern user_config_t   user_config;
 extern DEV_INFO_STRUCT dev_info;
+
+void side_ws2812_invalidate(void);
 extern uint16_t        rf_linking_time;
 extern uint16_t        no_act_time;
-extern bool            f_goto_sleep;
-extern bool            f_wakeup_prepare;
-
-uint8_t uart_send_cmd(uint8_t cmd, uint8_t ack_cnt, uint8_t delayms);
 
 /**
  * @brief  Sleep Handle.
@@ -72,6 +71,9 @@ void sleep_handle(void) {
         setPinOutput(DRIVER_SIDE_CS_PIN);
         writePinLow(DRIVER_SIDE_CS_PIN);
 
+        // the side LEDs lost their colors while powered off
+        side_ws2812_invalidate();
+
         uart_send_cmd(CMD_HAND, 0, 1);
 
         if (dev_info.link_mode == LINK_USB) {
@@ -16,6 +16,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "ansi.h"
+#include "rf.h"
 #include "usb_main.h"
 
 
@@ -31,7 +32,6 @@ DEV_INFO_STRUCT dev_info =
     .rf_state   = RF_IDLE,
 };
 
-bool f_uart_ack         = 0; 
 bool f_bat_show         = 0;  
 bool f_bat_hold         = 0;  
 bool f_dev_sleep_enable = 1; 
@@ -39,15 +39,8 @@ bool f_chg_show         = 1;
 bool f_sys_show         = 0; 
 bool f_sleep_show       = 0; 
 bool f_func_save        = 0;  
-bool f_rf_read_data_ok  = 0;  
-bool f_rf_sts_sysc_ok   = 0; 
-bool f_rf_new_adv_ok    = 0;  
-bool f_rf_reset         = 0;  
 bool f_send_channel     = 0;  
-bool f_rf_hand_ok       = 0;  
 bool f_dial_sw_init_ok  = 0;  
-bool f_goto_sleep       = 0; 
-bool f_wakeup_prepare   = 0; 
 bool f_rf_sw_press      = 0;  
 bool f_dev_reset_press  = 0;  
 bool f_rgb_test_press   = 0;  
@@ -64,15 +57,8 @@ uint16_t rf_sw_press_delay     = 0;
 uint16_t rgb_test_press_delay  = 0;  
 uint8_t rf_sw_temp             = 0;
 
-void rf_uart_init(void);
-void rf_device_init(void);
 void m_side_led_show(void);
-void dev_sts_sync(void);
-void uart_send_report_func(void);
-void uart_receive_pro(void);
 void Sleep_Handle(void);
-uint8_t uart_send_cmd(uint8_t cmd, uint8_t ack_cnt, uint8_t delayms);
-void uart_send_report(uint8_t report_type, uint8_t *report_buf, uint8_t report_size);
 
 void device_reset_show(void);
 void device_reset_init(void);
@@ -84,9 +70,6 @@ extern uint8_t side_speed;
 extern uint8_t side_rgb;    
 extern uint8_t side_colour;  
 extern report_keyboard_t *keyboard_report;
-extern uint8_t uart_bit_report_buf[32];
-extern uint8_t bitkb_report_buf[32];
-extern uint8_t bytekb_report_buf[8];
 
 extern void eeconfig_read_user_datablock(void *data);
 extern void eeconfig_update_user_datablock(const void *data);
@@ -122,6 +105,14 @@ void m_gpio_init(void)
     setPinInputHigh(SYS_MODE_PIN);
 }
 
+/**
+ * @brief  Clear the paired devices once the RF module has switched link.
+ */
+static void device_reset_link_done(uint8_t cmd, bool acked)
+{
+    uart_send_cmd(CMD_CLR_DEVICE, 10, 500);
+}
+
 /**
  * @brief  long press key process.
  */
@@ -141,13 +132,7 @@ void long_press_key(void)
             dev_info.rf_channel  = rf_sw_temp;
             dev_info.ble_channel = rf_sw_temp;
 
-            uint8_t timeout = 5;
-            while (timeout--) {
-                uart_send_cmd(CMD_NEW_ADV, 0, 1);
-                wait_ms(20);
-                uart_receive_pro();                   
-                if (f_rf_new_adv_ok) break;
-            }
+            rf_cmd_request(CMD_NEW_ADV, &f_rf_new_adv_ok, 5, 20, 1, NULL);
         }
     } else {
         rf_sw_press_delay = 0;
@@ -169,9 +154,7 @@ void long_press_key(void)
                 dev_info.rf_channel  = LINK_BT_1;
             }
 
-            uart_send_cmd(CMD_SET_LINK, 10, 10);
-            wait_ms(500);
-            uart_send_cmd(CMD_CLR_DEVICE, 10, 10);
+            rf_cmd_request(CMD_SET_LINK, &f_uart_ack, 1, 10, 10, device_reset_link_done);
 
             eeconfig_init();      
             device_reset_show();  
@@ -201,7 +184,7 @@ void long_press_key(void)
 /**
  * @brief  Release all keys, clear keyboard report.
  */
-void m_break_all_key(void)
+void break_all_key(void)
 {
     uint8_t report_buf[16];
     bool nkro_temp = keymap_config.nkro; 
@@ -231,8 +214,7 @@ void m_break_all_key(void)
     }
 
     memset(uart_bit_report_buf, 0, sizeof(uart_bit_report_buf));
-    memset(bitkb_report_buf, 0, sizeof(bitkb_report_buf));
-    memset(bytekb_report_buf, 0, sizeof(bytekb_report_buf));
+    uart_send_report_reset();
 }
 
 /**
@@ -242,11 +224,12 @@ void m_break_all_key(void)
 static void switch_dev_link(uint8_t mode)
 {
     if (mode > LINK_USB) return;
-    m_break_all_key();    
+    break_all_key();    
 
     dev_info.link_mode = mode; 
     dev_info.rf_state = RF_IDLE;
     f_send_channel = 1;
+    rf_link_kick();
 
     if (mode == LINK_USB) {
         host_mode = HOST_USB_TYPE;    
@@ -255,7 +238,7 @@ static void switch_dev_link(uint8_t mode)
     }
     else {
         host_mode = HOST_RF_TYPE; 
-        host_set_driver(0);           
+        host_set_driver(&rf_host_driver);           
 
     }
 }
@@ -283,7 +266,7 @@ void dial_sw_scan(void)
     if (readPin(SYS_MODE_PIN)) dial_scan |= 0X02;
 
     if (dial_save != dial_scan) {
-        m_break_all_key(); 
+        break_all_key(); 
 
         no_act_time     = 0;  
         rf_linking_time = 0; 
@@ -313,7 +296,7 @@ void dial_sw_scan(void)
             default_layer_set(1 << 0);  
             dev_info.sys_sw_state = SYS_SW_MAC;
             keymap_config.nkro    = 0; 
-            m_break_all_key();        
+            break_all_key();        
         }
     } else {
         if (dev_info.sys_sw_state != SYS_SW_WIN) {
@@ -321,7 +304,7 @@ void dial_sw_scan(void)
             default_layer_set(1 << 2);  
             dev_info.sys_sw_state = SYS_SW_WIN;
             keymap_config.nkro    = 1;  
-            m_break_all_key();        
+            break_all_key();        
         }
     }
 
@@ -330,7 +313,7 @@ void dial_sw_scan(void)
         f_first           = false;
 
         if (dev_info.link_mode != LINK_USB) {
-            host_set_driver(0);
+            host_set_driver(&rf_host_driver);
         }
     }
 }
@@ -380,14 +363,14 @@ void m_power_on_dial_sw_scan(void)
             default_layer_set(1 << 0);  
             dev_info.sys_sw_state = SYS_SW_MAC;
             keymap_config.nkro    = 0; 
-            m_break_all_key();  
+            break_all_key();  
         }
     } else {
         if (dev_info.sys_sw_state != SYS_SW_WIN) {
             default_layer_set(1 << 2);  
             dev_info.sys_sw_state = SYS_SW_WIN;
             keymap_config.nkro    = 1; 
-            m_break_all_key();     
+            break_all_key();     
         }
     }
 }
@@ -407,7 +390,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record)
 
         case LNK_USB:
             if (record->event.pressed) {
-                m_break_all_key();
+                break_all_key();
             } else {
                 dev_info.link_mode = LINK_USB;
                 uart_send_cmd(CMD_SET_LINK, 10, 10);
@@ -420,7 +403,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record)
                 if (dev_info.link_mode != LINK_USB) {
                     rf_sw_temp    = LINK_RF_24;
                     f_rf_sw_press = 1;
-                    m_break_all_key();
+                    break_all_key();
                 }
             } else if (f_rf_sw_press) {
                 f_rf_sw_press = 0;
@@ -438,7 +421,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record)
                 if (dev_info.link_mode != LINK_USB) {
                     rf_sw_temp    = LINK_BT_1;
                     f_rf_sw_press = 1;
-                    m_break_all_key();
+                    break_all_key();
                 }
             } else if (f_rf_sw_press) {
                 f_rf_sw_press = 0;
@@ -456,7 +439,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record)
                 if (dev_info.link_mode != LINK_USB) {
                     rf_sw_temp    = LINK_BT_2;
                     f_rf_sw_press = 1;
-                    m_break_all_key();
+                    break_all_key();
                 }
             } else if (f_rf_sw_press) {
                 f_rf_sw_press = 0;
@@ -474,7 +457,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record)
                 if (dev_info.link_mode != LINK_USB) {
                     rf_sw_temp    = LINK_BT_3;
                     f_rf_sw_press = 1;
-                    m_break_all_key();
+                    break_all_key();
                 }
             } else if (f_rf_sw_press) {
                 f_rf_sw_press = 0;
@@ -604,7 +587,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record)
         case DEV_RESET:
             if (record->event.pressed) {
                 f_dev_reset_press = 1;
-                m_break_all_key(); 
+                break_all_key(); 
             } else {
                 f_dev_reset_press = 0;
             }
@@ -715,8 +698,9 @@ void keyboard_post_init_user(void)
     rf_uart_init();               
     wait_ms(500);             
     rf_device_init();           
+    rf_link_start();
 
-    m_break_all_key();           
+    break_all_key();           
     m_londing_eeprom_data();    
     m_power_on_dial_sw_scan();  
 }
@@ -743,7 +727,7 @@ void housekeeping_task_user(void)
 
     uart_send_report_func();
 
-    dev_sts_sync();
+    rf_tx_task();
 
     long_press_key();
 
@@ -71,6 +71,7 @@ typedef enum {
 } TYPE_RX_STATE;
 
 #define FUNC_VALID_LEN   32
+#define UART_HEAD        0x5A
 
 #define RF_IDLE          0    
 #define RF_PAIRING       1  
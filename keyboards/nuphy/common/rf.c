@@ -0,0 +1,1252 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "rf.h"
+#include "uart.h" // qmk uart.h
+
+USART_MGR_STRUCT Usart_Mgr;
+#define RX_SBYTE    Usart_Mgr.RXDBuf[0]
+#define RX_CMD      Usart_Mgr.RXDBuf[1]
+#define RX_ACK      Usart_Mgr.RXDBuf[2]
+#define RX_LEN      Usart_Mgr.RXDBuf[3]
+#define RX_DAT      Usart_Mgr.RXDBuf[4]
+
+bool f_uart_ack        = 0;
+bool f_rf_read_data_ok = 0;
+bool f_rf_sts_sysc_ok  = 0;
+bool f_rf_new_adv_ok   = 0;
+bool f_rf_reset        = 0;
+bool f_rf_hand_ok      = 0;
+bool f_goto_sleep      = 0;
+bool f_wakeup_prepare  = 0;
+
+uint8_t  uart_bit_report_buf[32] = {0};
+uint8_t  func_tab[32]            = {0};
+uint8_t  bitkb_report_buf[32]    = {0};
+uint8_t  bytekb_report_buf[8]    = {0};
+uint8_t  sync_lost               = 0;
+uint8_t  disconnect_delay        = 0;
+
+#ifndef RF_DEVICE_NAME
+#    define RF_DEVICE_NAME          "NuPhy Air V2-"
+#endif
+
+#ifndef RF_TX_QUEUE_SIZE
+#    define RF_TX_QUEUE_SIZE        8
+#endif
+#ifndef RF_TX_HELD_SIZE
+#    define RF_TX_HELD_SIZE         4
+#endif
+#define RF_TX_FRAME_MAX             24   // largest frame is CMD_SET_NAME
+#define RF_TX_WAKEUP_US             50   // wakeup pin low before the first byte
+#define RF_TX_HOLD_US               50   // wakeup pin kept low after the last byte
+#define RF_TX_GAP_US                200  // idle time between two frames
+#define RF_RX_TIMEOUT_US            1000 // idle time after which a partial frame is dropped
+#define RF_RX_THREAD_STACK          256
+#ifndef RF_RX_QUEUE_SIZE
+#    define RF_RX_QUEUE_SIZE        4
+#endif
+
+#ifndef RF_REPORT_INTERVAL_MS
+#    define RF_REPORT_INTERVAL_MS   1    // keyboard report changes within this time go out as one report
+#endif
+#ifndef RF_REPORT_KEEPALIVE_MS
+#    define RF_REPORT_KEEPALIVE_MS  100  // resend the keyboard report after this much quiet time
+#endif
+
+#define RF_LINK_INTERVAL_LINKING    100  // status poll while linking or pairing
+#define RF_LINK_INTERVAL_ACTIVE     200  // status poll while connected, or on USB
+#define RF_LINK_INTERVAL_IDLE       1000 // status poll once connected and idle
+#define RF_LINK_IDLE_TIME           1000 // no_act_time before the poll slows down, in 10ms
+#define RF_LINK_BLINK_DELAY         2000 // time without connection before the link indicator blinks
+#define RF_LINK_REPLY_TIMEOUT       20
+#ifndef RF_LINK_RESET_DELAY
+#    define RF_LINK_RESET_DELAY     100
+#endif
+#define RF_LINK_RESET_PULSE         50
+#define RF_LINK_RESET_BOOT          50
+#define RF_LINK_BACKOFF_MAX         5    // further resets wait up to RF_LINK_INTERVAL_ACTIVE << 5
+
+typedef enum {
+    RF_LINK_POLL,
+    RF_LINK_WAIT_REPLY,
+    RF_LINK_RESET,
+    RF_LINK_RESET_RELEASE,
+    RF_LINK_CMD_SEND,
+    RF_LINK_CMD_WAIT_ACK,
+} rf_link_state_t;
+
+static deferred_token  rf_link_token   = INVALID_DEFERRED_TOKEN;
+static rf_link_state_t rf_link_state   = RF_LINK_POLL;
+static uint8_t         rf_link_backoff = 0;
+
+typedef enum {
+    RF_TX_IDLE,
+    RF_TX_WAKEUP,
+    RF_TX_SENDING,
+    RF_TX_HOLD,
+    RF_TX_GAP,
+} rf_tx_state_t;
+
+typedef struct {
+    uint8_t len;
+    uint8_t buf[RF_TX_FRAME_MAX];
+} rf_tx_frame_t;
+
+_Static_assert(sizeof(RF_DEVICE_NAME) - 1 + 7 <= RF_TX_FRAME_MAX, "RF_DEVICE_NAME too long");
+
+static rf_tx_frame_t rf_tx_queue[RF_TX_QUEUE_SIZE];
+static uint8_t       rf_tx_head     = 0;
+static uint8_t       rf_tx_count    = 0;
+static rf_tx_state_t rf_tx_state    = RF_TX_IDLE;
+static systime_t     rf_tx_time     = 0;
+static rf_tx_frame_t rf_tx_held[RF_TX_HELD_SIZE]; // reports waiting for room in the queue, oldest first
+static uint8_t       rf_tx_held_count = 0;
+uint16_t             rf_tx_overflow = 0; // frames dropped because neither the queue nor rf_tx_held had room
+static uint8_t       rf_tx_last_cmd = 0; // command of the last command frame, bare acks must match it
+
+typedef struct {
+    uint8_t len;
+    uint8_t buf[UART_MAX_LEN];
+} rf_rx_frame_t;
+
+typedef enum {
+    RF_RX_INCOMPLETE,
+    RF_RX_VALID,
+    RF_RX_INVALID,
+} rf_rx_check_t;
+
+static rf_rx_frame_t    rf_rx_frame; // frame being received, only used by rf_rx_thread
+static rf_rx_frame_t    rf_rx_queue[RF_RX_QUEUE_SIZE];
+static uint8_t          rf_rx_head  = 0;
+static volatile uint8_t rf_rx_count = 0;
+
+#ifndef RF_CMD_QUEUE_SIZE
+#    define RF_CMD_QUEUE_SIZE       4
+#endif
+
+typedef struct {
+    rf_tx_frame_t     frame;
+    bool             *reply;    // set by RF_Protocol_Receive() once the module answered
+    uint8_t           attempts; // frames left to send while no reply comes
+    uint8_t           wait_ack; // time to wait for the reply after each frame, in ms
+    uint16_t          delay;    // time before each frame, in ms
+    rf_cmd_callback_t callback;
+} rf_cmd_t;
+
+static rf_cmd_t rf_cmd_queue[RF_CMD_QUEUE_SIZE];
+static uint8_t  rf_cmd_head  = 0;
+static uint8_t  rf_cmd_count = 0;
+static uint16_t rf_cmd_timer = 0;
+
+static uint16_t rf_report_timer          = 0;
+static uint32_t rf_keepalive_timer       = 0;
+static bool     f_rf_report_pending      = 0;
+static bool     f_rf_pending_byte_report = 0;
+static uint8_t  rf_report_pending[KEYBOARD_REPORT_BITS + 1];
+
+extern DEV_INFO_STRUCT dev_info;
+extern host_driver_t  *m_host_driver;
+extern uint8_t         host_mode;
+extern uint8_t         rf_blink_cnt;
+extern uint16_t        rf_link_show_time;
+extern uint16_t        rf_linking_time;
+extern uint16_t        no_act_time;
+extern bool            f_send_channel;
+extern bool            f_dial_sw_init_ok;
+
+bool    UART_Send_Bytes(uint8_t *Buffer, uint32_t Length);
+uint8_t get_checksum(uint8_t *buf, uint8_t len);
+void    break_all_key(void);
+
+/**
+ * @brief Uart auto nkey send
+ */
+static bool f_bit_kb_act = 0;
+static void uart_auto_nkey_send(uint8_t *pre_bit_report, uint8_t *now_bit_report, uint8_t size)
+{
+    uint8_t i, j, byte_index;
+    uint8_t change_mask, offset_mask;
+    uint8_t key_code = 0;
+    bool f_byte_send = 0, f_bit_send = 0;
+
+    if (pre_bit_report[0] ^ now_bit_report[0]) {
+        bytekb_report_buf[0] = now_bit_report[0];
+        f_byte_send          = 1;
+    }
+
+    for (i = 1; i < size; i++) {
+        change_mask = pre_bit_report[i] ^ now_bit_report[i];
+        offset_mask = 1;
+        for (j = 0; j < 8; j++) {
+            if (change_mask & offset_mask) {
+                if (now_bit_report[i] & offset_mask) {
+                    for (byte_index = 2; byte_index < 8; byte_index++) {
+                        if (bytekb_report_buf[byte_index] == 0) {
+                            bytekb_report_buf[byte_index] = key_code;
+                            f_byte_send                   = 1;
+                            break;
+                        }
+                    }
+
+
+                    if (byte_index >= 8) {
+                        uart_bit_report_buf[i] |= offset_mask;
+                        f_bit_send = 1;
+                    }
+                } else {
+                    for (byte_index = 2; byte_index < 8; byte_index++) {
+                        if (bytekb_report_buf[byte_index] == key_code) {
+                            bytekb_report_buf[byte_index] = 0;
+                            f_byte_send                   = 1;
+                            break;
+                            ;
+                        }
+                    }
+                    if (byte_index >= 8) {
+                        uart_bit_report_buf[i] &= ~offset_mask;
+                        f_bit_send = 1;
+                    }
+                }
+            }
+            key_code++;
+            offset_mask <<= 1;
+        }
+    }
+
+    if (f_bit_send) {
+        f_bit_kb_act = 1;
+        uart_send_report(CMD_RPT_BIT_KB, uart_bit_report_buf, 16);
+    }
+
+    if (f_byte_send) {
+        uart_send_report(CMD_RPT_BYTE_KB, bytekb_report_buf, 8);
+    }
+}
+
+
+/**
+ * @brief  Send the keyboard report `report` to the RF module.
+ * @note  Only the difference to the report the host last got goes out, see uart_auto_nkey_send().
+ */
+static void rf_kb_report_send(bool f_byte_report, uint8_t *report)
+{
+    if (f_byte_report) {
+        memcpy(bytekb_report_buf, report, 8);
+        uart_send_report(CMD_RPT_BYTE_KB, bytekb_report_buf, 8);
+    } else {
+        uart_auto_nkey_send(bitkb_report_buf, report, KEYBOARD_REPORT_BITS + 1);
+        memcpy(bitkb_report_buf, report, KEYBOARD_REPORT_BITS + 1);
+    }
+
+    no_act_time        = 0;
+    rf_report_timer    = timer_read();
+    rf_keepalive_timer = timer_read32();
+}
+
+/**
+ * @brief  Check if `now` undoes a change `pending` still holds back from the host.
+ * @note  Key slots of the byte report are compared as a whole, a slot going from one key
+ *        straight to another is a release and a press.
+ */
+static bool rf_kb_report_reverts(bool f_byte_report, const uint8_t *sent, const uint8_t *pending, const uint8_t *now, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++) {
+        uint8_t pending_change = sent[i] ^ pending[i];
+        uint8_t now_change     = pending[i] ^ now[i];
+
+        if (f_byte_report && (i >= 2)) {
+            if (pending_change && now_change) return true;
+        } else if (pending_change & now_change) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief  Drop the report state of the RF path, after all keys were released on the host.
+ */
+void uart_send_report_reset(void)
+{
+    memset(bitkb_report_buf, 0, sizeof(bitkb_report_buf));
+    memset(bytekb_report_buf, 0, sizeof(bytekb_report_buf));
+    f_rf_report_pending = 0;
+}
+
+/**
+ * @brief  Uart send keys report.
+ * @note Call in housekeeping. Sends the report rf_send_keyboard() held back once
+ *       RF_REPORT_INTERVAL_MS has passed, and keepalives while nothing else is on the way.
+ */
+void uart_send_report_func(void)
+{
+    if (dev_info.link_mode == LINK_USB) return;
+    keyboard_protocol          = 1;
+
+    if (f_rf_report_pending && (timer_elapsed(rf_report_timer) >= RF_REPORT_INTERVAL_MS)) {
+        f_rf_report_pending = 0;
+        rf_kb_report_send(f_rf_pending_byte_report, rf_report_pending);
+    }
+
+    if (f_rf_report_pending || rf_tx_count || rf_tx_held_count || (rf_tx_state != RF_TX_IDLE)) return;
+
+    if (timer_elapsed32(rf_keepalive_timer) >= RF_REPORT_KEEPALIVE_MS) {
+        rf_keepalive_timer = timer_read32();
+        if (no_act_time <= 200) {
+            uart_send_report(CMD_RPT_BYTE_KB, bytekb_report_buf, 8);
+
+            if (f_bit_kb_act)
+                uart_send_report(CMD_RPT_BIT_KB, uart_bit_report_buf, 16);
+        } else {
+            f_bit_kb_act = 0;
+        }
+    }
+}
+
+/**
+ * @brief  RF host driver, lock key state as last reported by the RF module.
+ */
+static uint8_t rf_keyboard_leds(void) {
+    return dev_info.rf_led;
+}
+
+/**
+ * @brief  RF host driver, keyboard report.
+ * @note The first change after a quiet interval goes out at once, further changes within
+ *       RF_REPORT_INTERVAL_MS are merged into one report. A change that undoes a held back
+ *       one sends the held back report first, so no edge gets lost.
+ */
+static void rf_send_keyboard(report_keyboard_t *report) {
+    if (dev_info.link_mode == LINK_USB) return;
+
+    if (keymap_config.nkro) {
+        report->nkro.mods = get_mods() | get_weak_mods();
+    }
+
+    bool     f_byte_report = (dev_info.sys_sw_state == SYS_SW_MAC);
+    uint8_t *now           = f_byte_report ? report->raw : &report->nkro.mods;
+    uint8_t *sent          = f_byte_report ? bytekb_report_buf : bitkb_report_buf;
+    uint8_t  len           = f_byte_report ? 8 : KEYBOARD_REPORT_BITS + 1;
+
+    if (f_byte_report) report->raw[1] = 0;
+
+    if (f_rf_report_pending && (f_rf_pending_byte_report != f_byte_report)) {
+        f_rf_report_pending = 0;
+        rf_kb_report_send(f_rf_pending_byte_report, rf_report_pending);
+    }
+
+    if (!f_rf_report_pending) {
+        if (memcmp(sent, now, len) == 0) return;
+
+        if (timer_elapsed(rf_report_timer) >= RF_REPORT_INTERVAL_MS) {
+            rf_kb_report_send(f_byte_report, now);
+        } else {
+            memcpy(rf_report_pending, now, len);
+            f_rf_pending_byte_report = f_byte_report;
+            f_rf_report_pending      = 1;
+        }
+    } else if (memcmp(rf_report_pending, now, len)) {
+        if (rf_kb_report_reverts(f_byte_report, sent, rf_report_pending, now, len)) {
+            rf_kb_report_send(f_byte_report, rf_report_pending);
+        }
+        memcpy(rf_report_pending, now, len);
+    }
+}
+
+/**
+ * @brief  RF host driver, mouse report.
+ */
+static void rf_send_mouse(report_mouse_t *report) {
+    no_act_time = 0;
+    uart_send_report(CMD_RPT_MS, &report->buttons, 5);
+}
+
+/**
+ * @brief  RF host driver, system and consumer usages.
+ */
+static void rf_send_extra(report_extra_t *report) {
+    uint16_t usage = report->usage;
+
+    no_act_time = 0;
+    if (report->report_id == REPORT_ID_SYSTEM) {
+        uart_send_report(CMD_RPT_SYS, (uint8_t *)&usage, 2);
+    } else if (report->report_id == REPORT_ID_CONSUMER) {
+        uart_send_report(CMD_RPT_CONSUME, (uint8_t *)&usage, 2);
+    }
+}
+
+/* Reports go to the RF module while this driver is set, see rf_link_task() */
+host_driver_t rf_host_driver = {rf_keyboard_leds, rf_send_keyboard, rf_send_mouse, rf_send_extra};
+
+/**
+ * @brief  Parsing the data received from the RF module.
+ */
+void RF_Protocol_Receive(void) {
+    if (Usart_Mgr.RXDState == RX_Done) {
+        // The length and checksum were checked by rf_rx_thread. A bare ack carries
+        // neither, it only counts for the command that is waiting for one.
+        bool bare_ack = Usart_Mgr.RXDLen == 3;
+        if (!bare_ack || RX_CMD == rf_tx_last_cmd) {
+            f_uart_ack = 1;
+        }
+        sync_lost = 0;
+
+        switch (RX_CMD) {
+            case CMD_HAND: {
+                f_rf_hand_ok = 1;
+                break;
+            }
+
+            case CMD_24G_SUSPEND: {
+                f_goto_sleep = 1;
+                break;
+            }
+
+            case CMD_NEW_ADV: {
+                f_rf_new_adv_ok = 1;
+                break;
+            }
+
+            case CMD_RF_STS_SYSC: {
+                static uint8_t error_cnt = 0;
+
+                if (bare_ack || RX_LEN < 5) break;
+
+                if (dev_info.link_mode == Usart_Mgr.RXDBuf[4]) {
+                    error_cnt = 0;
+
+                    dev_info.rf_state = Usart_Mgr.RXDBuf[5];
+
+                    if ((dev_info.rf_state == RF_CONNECT) && ((Usart_Mgr.RXDBuf[6] & 0xf8) == 0)) {
+                        dev_info.rf_led = Usart_Mgr.RXDBuf[6];
+                    }
+
+                    dev_info.rf_charge = Usart_Mgr.RXDBuf[7];
+
+                    if (Usart_Mgr.RXDBuf[8] <= 100) dev_info.rf_baterry = Usart_Mgr.RXDBuf[8];
+                    if (dev_info.rf_charge & 0x01) dev_info.rf_baterry = 100;
+                }
+                else {
+                    if (dev_info.rf_state != RF_INVAILD) {
+                        if (error_cnt >= 5) {
+                            error_cnt      = 0;
+                            f_send_channel = 1;
+                        } else {
+                            error_cnt++;
+                        }
+                    }
+                }
+
+                f_rf_sts_sysc_ok = 1;
+                break;
+            }
+
+            case CMD_READ_DATA: {
+                if (bare_ack || RX_LEN < 32) break;
+
+                memcpy(func_tab, &Usart_Mgr.RXDBuf[4], 32);
+
+                if (func_tab[4] <= LINK_USB) {
+                    dev_info.link_mode = func_tab[4];
+                }
+
+                if (func_tab[5] < LINK_USB) {
+                    dev_info.rf_channel = func_tab[5];
+                }
+
+                if ((func_tab[6] <= LINK_BT_3) && (func_tab[6] >= LINK_BT_1)) {
+                    dev_info.ble_channel = func_tab[6];
+                }
+
+                f_rf_read_data_ok = 1;
+                break;
+            }
+        }
+
+        Usart_Mgr.RXDLen      = 0;
+        Usart_Mgr.RXDState    = RX_Idle;
+        Usart_Mgr.RXDOverTime = 0;
+    }
+}
+
+/**
+ * @brief  Build a command frame in Usart_Mgr.TXDBuf.
+ * @param  cmd: cmd.
+ * @return frame length.
+ */
+static uint8_t rf_cmd_build(uint8_t cmd) {
+    memset(&Usart_Mgr.TXDBuf[0], 0, UART_MAX_LEN);
+
+    Usart_Mgr.TXDBuf[0] = UART_HEAD;
+    Usart_Mgr.TXDBuf[1] = cmd;
+    Usart_Mgr.TXDBuf[2] = 0x00;
+
+    switch (cmd) {
+        case CMD_SLEEP: {
+            Usart_Mgr.TXDBuf[3] = 1;
+            Usart_Mgr.TXDBuf[4] = 0;
+            Usart_Mgr.TXDBuf[5] = 0;
+            break;
+        }
+
+        case CMD_HAND: {
+            Usart_Mgr.TXDBuf[3] = 1;
+            Usart_Mgr.TXDBuf[4] = 0;
+            Usart_Mgr.TXDBuf[5] = 0;
+            break;
+        }
+
+        case CMD_RF_STS_SYSC: {
+            Usart_Mgr.TXDBuf[3] = 1;
+            Usart_Mgr.TXDBuf[4] = dev_info.link_mode;
+            Usart_Mgr.TXDBuf[5] = dev_info.link_mode;
+            break;
+        }
+
+        case CMD_SET_LINK: {
+            dev_info.rf_state   = RF_LINKING;
+            Usart_Mgr.TXDBuf[3] = 1;
+            Usart_Mgr.TXDBuf[4] = dev_info.link_mode;
+            Usart_Mgr.TXDBuf[5] = dev_info.link_mode;
+
+            rf_linking_time  = 0;
+            disconnect_delay = 0xff;
+            rf_link_kick();
+            break;
+        }
+
+        case CMD_NEW_ADV: {
+            dev_info.rf_state   = RF_PAIRING;
+            Usart_Mgr.TXDBuf[3] = 2;
+            Usart_Mgr.TXDBuf[4] = dev_info.link_mode;
+            Usart_Mgr.TXDBuf[5] = 1;
+            Usart_Mgr.TXDBuf[6] = dev_info.link_mode + 1;
+
+            rf_linking_time  = 0;
+            disconnect_delay = 0xff;
+            rf_link_kick();
+            f_rf_new_adv_ok  = 0;
+            break;
+        }
+
+        case CMD_CLR_DEVICE: {
+            Usart_Mgr.TXDBuf[3] = 1;
+            Usart_Mgr.TXDBuf[4] = 0;
+            Usart_Mgr.TXDBuf[5] = 0;
+            break;
+        }
+
+        case CMD_SET_CONFIG: {
+            Usart_Mgr.TXDBuf[3] = 1;
+            Usart_Mgr.TXDBuf[4] = POWER_DOWN_DELAY;
+            Usart_Mgr.TXDBuf[5] = POWER_DOWN_DELAY;
+            break;
+        }
+
+        case CMD_SET_NAME: {
+            uint8_t name_len = sizeof(RF_DEVICE_NAME) - 1;
+
+            Usart_Mgr.TXDBuf[3] = name_len + 2;
+            Usart_Mgr.TXDBuf[4] = 1;
+            Usart_Mgr.TXDBuf[5] = name_len;
+            memcpy(&Usart_Mgr.TXDBuf[6], RF_DEVICE_NAME, name_len);
+            Usart_Mgr.TXDBuf[6 + name_len] = get_checksum(Usart_Mgr.TXDBuf + 4, Usart_Mgr.TXDBuf[3]);
+            break;
+        }
+
+        case CMD_READ_DATA: {
+            Usart_Mgr.TXDBuf[3] = 2;
+            Usart_Mgr.TXDBuf[4] = 0x00;
+            Usart_Mgr.TXDBuf[5] = FUNC_VALID_LEN;
+            Usart_Mgr.TXDBuf[6] = FUNC_VALID_LEN;
+            break;
+        }
+
+        case CMD_RF_DFU: {
+            Usart_Mgr.TXDBuf[3] = 1;
+            Usart_Mgr.TXDBuf[4] = 0;
+            Usart_Mgr.TXDBuf[5] = 0;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return Usart_Mgr.TXDBuf[3] + 5;
+}
+
+/**
+ * @brief  Send a command frame right away, without waiting for the reply.
+ * @param  cmd: cmd.
+ */
+static void rf_cmd_send_now(uint8_t cmd) {
+    f_uart_ack     = 0;
+    rf_tx_last_cmd = cmd;
+    if (!UART_Send_Bytes(Usart_Mgr.TXDBuf, rf_cmd_build(cmd))) rf_tx_overflow++;
+}
+
+/**
+ * @brief  Queue a command for the link manager.
+ * @param  cmd: cmd.
+ * @param  reply: flag set by RF_Protocol_Receive() once the module answered.
+ * @param  attempts: frames sent at most while no reply comes.
+ * @param  wait_ack: wait time for the reply after each frame, 0 to not wait.
+ * @param  delayms: delay before each frame.
+ * @param  callback: called with the outcome once the command is done, may be NULL.
+ * @note   The frame is built right away, so it carries the link settings of the moment
+ *         the command was queued. Returns TX_BUSY if the command queue is full.
+ */
+uint8_t rf_cmd_request(uint8_t cmd, bool *reply, uint8_t attempts, uint8_t wait_ack, uint16_t delayms, rf_cmd_callback_t callback) {
+    if (rf_cmd_count >= RF_CMD_QUEUE_SIZE) return TX_BUSY;
+
+    rf_cmd_t *entry = &rf_cmd_queue[(rf_cmd_head + rf_cmd_count++) % RF_CMD_QUEUE_SIZE];
+
+    entry->frame.len = MIN(rf_cmd_build(cmd), RF_TX_FRAME_MAX);
+    memcpy(entry->frame.buf, Usart_Mgr.TXDBuf, entry->frame.len);
+    entry->reply    = reply;
+    entry->attempts = MAX(attempts, 1);
+    entry->wait_ack = wait_ack;
+    entry->delay    = delayms;
+    entry->callback = callback;
+
+    rf_link_kick();
+    return TX_OK;
+}
+
+/**
+ * @brief  Uart send cmd.
+ * @param  cmd: cmd.
+ * @param  wait_ack: wait time for ack after sending.
+ * @param  delayms: delay before sending.
+ * @note   Only queues the command, the link manager sends it and waits for the ack.
+ */
+uint8_t uart_send_cmd(uint8_t cmd, uint8_t wait_ack, uint16_t delayms) {
+    return rf_cmd_request(cmd, &f_uart_ack, 1, wait_ack, delayms, NULL);
+}
+
+/**
+ * @brief Status poll interval for the current link state.
+ */
+static uint32_t rf_link_interval(void) {
+    if (dev_info.link_mode == LINK_USB) return RF_LINK_INTERVAL_ACTIVE;
+    if (dev_info.rf_state != RF_CONNECT) return RF_LINK_INTERVAL_LINKING;
+    if (no_act_time >= RF_LINK_IDLE_TIME) return RF_LINK_INTERVAL_IDLE;
+    return RF_LINK_INTERVAL_ACTIVE;
+}
+
+/**
+ * @brief Pick the next step once the link manager is done with the current one.
+ * @param interval  time until the next status poll if no command is waiting
+ */
+static uint32_t rf_link_next(uint32_t interval) {
+    if (rf_cmd_count) {
+        rf_link_state = RF_LINK_CMD_SEND;
+        return MAX(rf_cmd_queue[rf_cmd_head].delay, 1);
+    }
+
+    rf_link_state = RF_LINK_POLL;
+    return interval;
+}
+
+/**
+ * @brief Drop the command at the head of the queue and report its outcome.
+ */
+static uint32_t rf_cmd_done(bool acked) {
+    rf_cmd_callback_t callback = rf_cmd_queue[rf_cmd_head].callback;
+    uint8_t           cmd      = rf_cmd_queue[rf_cmd_head].frame.buf[1];
+
+    // Pop first, the callback may queue the next command
+    rf_cmd_head = (rf_cmd_head + 1) % RF_CMD_QUEUE_SIZE;
+    rf_cmd_count--;
+    if (callback) callback(cmd, acked);
+
+    return rf_link_next(rf_link_interval());
+}
+
+/**
+ * @brief RF link manager, run from deferred_exec.
+ * @note Polls the RF module state, keeps the host driver in sync with the link mode,
+ *       sends the queued commands and resets an unresponsive module. Every step returns
+ *       the time until the next one, nothing here waits.
+ */
+static uint32_t rf_link_task(uint32_t trigger_time, void *cb_arg) {
+    static uint8_t link_state_temp = RF_DISCONNECT;
+
+    switch (rf_link_state) {
+        case RF_LINK_RESET:
+            writePinLow(NRF_RESET_PIN);
+            rf_link_state = RF_LINK_RESET_RELEASE;
+            return RF_LINK_RESET_PULSE;
+
+        case RF_LINK_RESET_RELEASE:
+            writePinHigh(NRF_RESET_PIN);
+            rf_link_state = RF_LINK_POLL;
+            return RF_LINK_RESET_BOOT;
+
+        case RF_LINK_CMD_SEND: {
+            rf_cmd_t *cmd = &rf_cmd_queue[rf_cmd_head];
+
+            f_uart_ack     = 0;
+            *cmd->reply    = 0;
+            rf_tx_last_cmd = cmd->frame.buf[1];
+            if (!UART_Send_Bytes(cmd->frame.buf, cmd->frame.len)) return 1; // transmit queue full, try again
+            cmd->attempts--;
+            rf_cmd_timer  = timer_read();
+            rf_link_state = RF_LINK_CMD_WAIT_ACK;
+            return 1;
+        }
+
+        case RF_LINK_CMD_WAIT_ACK: {
+            rf_cmd_t *cmd = &rf_cmd_queue[rf_cmd_head];
+
+            // Time the reply from the moment the frame is out
+            if (rf_tx_count) rf_cmd_timer = timer_read();
+            if (*cmd->reply) return rf_cmd_done(true);
+            if (timer_elapsed(rf_cmd_timer) < cmd->wait_ack) return 1;
+            if (!cmd->attempts) return rf_cmd_done(false);
+
+            rf_link_state = RF_LINK_CMD_SEND;
+            return MAX(cmd->delay, 1);
+        }
+
+        case RF_LINK_WAIT_REPLY:
+            if (f_rf_sts_sysc_ok) {
+                rf_link_backoff = 0;
+            } else if (dev_info.link_mode != LINK_USB) {
+                if (++sync_lost >= 5) {
+                    sync_lost  = 0;
+                    f_rf_reset = 1;
+                }
+            }
+            return rf_link_next(rf_link_interval() - RF_LINK_REPLY_TIMEOUT);
+
+        case RF_LINK_POLL:
+            break;
+    }
+
+    if (f_rf_reset) {
+        f_rf_reset    = 0;
+        rf_link_state = RF_LINK_RESET;
+
+        // Back off exponentially while the module stays silent after being reset
+        uint32_t delay = RF_LINK_RESET_DELAY;
+        if (rf_link_backoff) delay += (uint32_t)RF_LINK_INTERVAL_ACTIVE << rf_link_backoff;
+        if (rf_link_backoff < RF_LINK_BACKOFF_MAX) rf_link_backoff++;
+        return delay;
+    }
+    else if (f_send_channel) {
+        f_send_channel = 0;
+        rf_cmd_send_now(CMD_SET_LINK);
+    }
+
+    if (dev_info.link_mode == LINK_USB) {
+        if (host_mode != HOST_USB_TYPE) {
+            host_mode = HOST_USB_TYPE;
+            host_set_driver(m_host_driver);
+            break_all_key();
+        }
+        rf_blink_cnt = 0;
+    }
+    else {
+        if (host_mode != HOST_RF_TYPE) {
+            host_mode = HOST_RF_TYPE;
+            break_all_key();
+            host_set_driver(&rf_host_driver);
+        }
+
+        if (dev_info.rf_state != RF_CONNECT) {
+            if (disconnect_delay >= RF_LINK_BLINK_DELAY / RF_LINK_INTERVAL_LINKING) {
+                rf_blink_cnt    = 3;
+                rf_link_show_time = 0;
+                link_state_temp = dev_info.rf_state;
+            } else {
+                disconnect_delay++;
+            }
+        }
+        else if (dev_info.rf_state == RF_CONNECT) {
+            rf_linking_time  = 0;
+            disconnect_delay = 0;
+            rf_blink_cnt     = 0;
+
+            if (link_state_temp != RF_CONNECT) {
+                link_state_temp   = RF_CONNECT;
+                rf_link_show_time = 0;
+            }
+        }
+    }
+
+    // Queued commands go first, the status poll follows once they are done
+    if (rf_cmd_count) return rf_link_next(0);
+
+    // Leave the module alone while it is put to sleep or woken up
+    if (f_wakeup_prepare || f_goto_sleep) return rf_link_interval();
+
+    f_rf_sts_sysc_ok = 0;
+    rf_cmd_send_now(CMD_RF_STS_SYSC);
+    rf_link_state = RF_LINK_WAIT_REPLY;
+    return RF_LINK_REPLY_TIMEOUT;
+}
+
+/**
+ * @brief Start the RF link manager.
+ */
+void rf_link_start(void) {
+    rf_link_token = defer_exec(RF_LINK_INTERVAL_ACTIVE, rf_link_task, NULL);
+}
+
+/**
+ * @brief Run the RF link manager right away, after the link mode changed.
+ */
+void rf_link_kick(void) {
+    if (rf_link_state == RF_LINK_POLL) extend_deferred_exec(rf_link_token, 1);
+}
+
+/**
+ * @brief Reserve a frame at the end of the transmit queue.
+ * @note Returns NULL if the queue is full, nothing waits for it to drain.
+ */
+static rf_tx_frame_t *rf_tx_enqueue(void) {
+    if (rf_tx_count >= RF_TX_QUEUE_SIZE) return NULL;
+
+    return &rf_tx_queue[(rf_tx_head + rf_tx_count++) % RF_TX_QUEUE_SIZE];
+}
+
+/**
+ * @brief Move the held reports to the transmit queue as far as it has room, oldest first.
+ */
+static void rf_tx_release_held(void) {
+    while (rf_tx_held_count) {
+        rf_tx_frame_t *frame = rf_tx_enqueue();
+        if (!frame) return;
+
+        *frame = rf_tx_held[0];
+        rf_tx_held_count--;
+        memmove(&rf_tx_held[0], &rf_tx_held[1], rf_tx_held_count * sizeof(rf_tx_frame_t));
+    }
+}
+
+/**
+ * @brief Last queued frame, if the state machine hasn't started sending it yet.
+ */
+static rf_tx_frame_t *rf_tx_pending_tail(void) {
+    uint8_t in_flight = (rf_tx_state == RF_TX_IDLE || rf_tx_state == RF_TX_GAP) ? 0 : 1;
+
+    if (rf_tx_count <= in_flight) return NULL;
+    return &rf_tx_queue[(rf_tx_head + rf_tx_count - 1) % RF_TX_QUEUE_SIZE];
+}
+
+/**
+ * @brief Newest report of this type queued or held before `frame`, sent or not.
+ */
+static rf_tx_frame_t *rf_tx_report_before(rf_tx_frame_t *frame) {
+    bool passed = false;
+
+    for (uint8_t i = rf_tx_held_count; i > 0; i--) {
+        rf_tx_frame_t *held = &rf_tx_held[i - 1];
+        if (passed && (held->buf[1] == frame->buf[1])) return held;
+        passed |= (held == frame);
+    }
+    for (uint8_t i = rf_tx_count; i > 0; i--) {
+        rf_tx_frame_t *queued = &rf_tx_queue[(rf_tx_head + i - 1) % RF_TX_QUEUE_SIZE];
+        if (passed && (queued->buf[1] == frame->buf[1])) return queued;
+        passed |= (queued == frame);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Whether a report of the byte keyboard format contains the keycode.
+ */
+static bool rf_byte_report_has_key(const uint8_t *report, uint8_t keycode) {
+    for (uint8_t i = 2; i < 8; i++) {
+        if (report[i] == keycode) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Whether `prev`, `frame`, `next` can become `prev`, `next` without the host missing a press or release.
+ * @note Every key or bit `frame` changes from `prev` has to keep its new state in `next`.
+ */
+static bool rf_report_no_edge_lost(const rf_tx_frame_t *prev, const rf_tx_frame_t *frame, const uint8_t *next) {
+    const uint8_t *p    = &prev->buf[4];
+    const uint8_t *h    = &frame->buf[4];
+    uint8_t        size = frame->buf[3];
+
+    switch (frame->buf[1]) {
+        case CMD_RPT_BIT_KB:
+            for (uint8_t i = 0; i < size; i++) {
+                if ((p[i] ^ h[i]) & (h[i] ^ next[i])) return false;
+            }
+            return true;
+
+        case CMD_RPT_BYTE_KB:
+            if ((p[0] ^ h[0]) & (h[0] ^ next[0])) return false;
+            for (uint8_t i = 2; i < 8; i++) {
+                // a key pressed in frame has to stay pressed, a key released in frame has to stay released
+                if (h[i] && !rf_byte_report_has_key(p, h[i]) && !rf_byte_report_has_key(next, h[i])) return false;
+                if (p[i] && !rf_byte_report_has_key(h, p[i]) && rf_byte_report_has_key(next, p[i])) return false;
+            }
+            return true;
+
+        default:
+            // a single usage: only a report that changes nothing can be replaced
+            return memcmp(p, h, size) == 0;
+    }
+}
+
+/**
+ * @brief Merge a report into a queued or held one of the same type without losing a transition.
+ * @return true if `frame` now carries the report.
+ */
+static bool rf_tx_merge_report(rf_tx_frame_t *frame, uint8_t *report_buf, uint8_t report_size) {
+    if (frame->buf[1] == CMD_RPT_MS) {
+        if (frame->buf[4] != report_buf[0]) return false;
+
+        // Same buttons, add up the movement if it still fits
+        for (uint8_t i = 1; i < report_size; i++) {
+            int16_t sum = (int8_t)frame->buf[4 + i] + (int8_t)report_buf[i];
+            if ((sum < INT8_MIN) || (sum > INT8_MAX)) return false;
+        }
+        for (uint8_t i = 1; i < report_size; i++) {
+            frame->buf[4 + i] = (uint8_t)((int8_t)frame->buf[4 + i] + (int8_t)report_buf[i]);
+        }
+    } else if (memcmp(&frame->buf[4], report_buf, report_size) != 0) {
+        rf_tx_frame_t *prev = rf_tx_report_before(frame);
+        if (!prev || !rf_report_no_edge_lost(prev, frame, report_buf)) return false;
+
+        memcpy(&frame->buf[4], report_buf, report_size);
+    }
+
+    frame->buf[4 + report_size] = get_checksum(&frame->buf[4], report_size);
+    return true;
+}
+
+/**
+ * @brief Run the RF transmit state machine.
+ * @note Frames are sent one at a time: the wakeup pin is pulled low, the frame is
+ *       handed to the interrupt driven serial driver, and the pin is released once
+ *       the last byte has left the shift register. Call it as often as possible.
+ */
+void rf_tx_task(void) {
+    rf_tx_release_held();
+
+    while (true) {
+        systime_t      now   = chVTGetSystemTimeX();
+        rf_tx_frame_t *frame = &rf_tx_queue[rf_tx_head];
+
+        switch (rf_tx_state) {
+            case RF_TX_IDLE:
+                if (rf_tx_count == 0) return;
+                writePinLow(NRF_WAKEUP_PIN);
+                Usart_Mgr.TXDOffset = 0;
+                rf_tx_time          = now;
+                rf_tx_state         = RF_TX_WAKEUP;
+                break;
+
+            case RF_TX_WAKEUP:
+                if (chTimeDiffX(rf_tx_time, now) < TIME_US2I(RF_TX_WAKEUP_US)) return;
+                rf_tx_state = RF_TX_SENDING;
+                break;
+
+            case RF_TX_SENDING: {
+                if (Usart_Mgr.TXDOffset < frame->len) {
+                    Usart_Mgr.TXDOffset += sdAsynchronousWrite(&SERIAL_DRIVER, &frame->buf[Usart_Mgr.TXDOffset], frame->len - Usart_Mgr.TXDOffset);
+                    if (Usart_Mgr.TXDOffset < frame->len) return;
+                }
+
+                osalSysLock();
+                bool queued = !oqIsEmptyI(&SERIAL_DRIVER.oqueue);
+                osalSysUnlock();
+                if (queued || !(USART1->ISR & USART_ISR_TC)) return;
+
+                rf_tx_time  = now;
+                rf_tx_state = RF_TX_HOLD;
+                break;
+            }
+
+            case RF_TX_HOLD:
+                if (chTimeDiffX(rf_tx_time, now) < TIME_US2I(RF_TX_HOLD_US)) return;
+                writePinHigh(NRF_WAKEUP_PIN);
+                rf_tx_head  = (rf_tx_head + 1) % RF_TX_QUEUE_SIZE;
+                rf_tx_count--;
+                rf_tx_time  = now;
+                rf_tx_state = RF_TX_GAP;
+                rf_tx_release_held();
+                break;
+
+            case RF_TX_GAP:
+                if (chTimeDiffX(rf_tx_time, now) < TIME_US2I(RF_TX_GAP_US)) return;
+                rf_tx_state = RF_TX_IDLE;
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Uart send bytes.
+ * @param Buffer data buf
+ * @param Length data lenght
+ * @note The bytes are copied to the transmit queue and sent in the background by rf_tx_task().
+ *       Returns false if the queue is full.
+ */
+bool UART_Send_Bytes(uint8_t *Buffer, uint32_t Length) {
+    rf_tx_frame_t *frame = rf_tx_enqueue();
+    if (!frame) return false;
+
+    frame->len = MIN(Length, RF_TX_FRAME_MAX);
+    memcpy(frame->buf, Buffer, frame->len);
+
+    rf_tx_task();
+    return true;
+}
+
+/**
+ * @brief get checksum.
+ * @param buf data buf
+ * @param len data lenght
+ */
+uint8_t get_checksum(uint8_t *buf, uint8_t len) {
+    uint8_t i;
+    uint8_t checksum = 0;
+
+    for (i = 0; i < len; i++)
+        checksum += *buf++;
+
+    checksum ^= UART_HEAD;
+
+    return checksum;
+}
+
+/**
+ * @brief Uart send report.
+ * @param report_type  report_type
+ * @param report_buf  report_buf
+ * @param report_size  report_size
+ */
+void uart_send_report(uint8_t report_type, uint8_t *report_buf, uint8_t report_size) {
+    if (f_dial_sw_init_ok == 0) return;
+    if (dev_info.link_mode == LINK_USB) return;
+    if (dev_info.rf_state != RF_CONNECT) return;
+
+    // Merge with a report of the same type still waiting to be sent, as long as no key transition gets lost.
+    // Held reports go out after the queue, so a new report can only be merged into the newest of them.
+    rf_tx_frame_t *frame = rf_tx_held_count ? &rf_tx_held[rf_tx_held_count - 1] : rf_tx_pending_tail();
+    if (frame && (frame->buf[1] == report_type) && (frame->buf[3] == report_size)) {
+        if (rf_tx_merge_report(frame, report_buf, report_size)) return;
+    }
+
+    // With the queue full the report is held back and rf_tx_task() queues it once there is room
+    frame = rf_tx_held_count ? NULL : rf_tx_enqueue();
+    if (!frame && (rf_tx_held_count < RF_TX_HELD_SIZE)) frame = &rf_tx_held[rf_tx_held_count++];
+    if (!frame) {
+        rf_tx_overflow++;
+        return;
+    }
+
+    frame->buf[0] = UART_HEAD;
+    frame->buf[1] = report_type;
+    frame->buf[2] = 0x01;
+    frame->buf[3] = report_size;
+
+    memcpy(&frame->buf[4], report_buf, report_size);
+    frame->buf[4 + report_size] = get_checksum(&frame->buf[4], report_size);
+    frame->len                  = report_size + 5;
+
+    rf_tx_task();
+}
+
+/**
+ * @brief Check the frame received so far.
+ * @note Frames are [head][cmd][ack][len][data...][checksum], or [head][cmd][0xA0] for a bare ack.
+ */
+static rf_rx_check_t rf_rx_check(const rf_rx_frame_t *frame) {
+    const uint8_t *buf = frame->buf;
+
+    if ((frame->len == 3) && (buf[2] == 0xA0)) return RF_RX_VALID;
+    if (frame->len < 4) return RF_RX_INCOMPLETE;
+    if (buf[3] + 5 > UART_MAX_LEN) return RF_RX_INVALID;
+    if (frame->len < buf[3] + 5) return RF_RX_INCOMPLETE;
+
+    uint8_t check_sum = 0;
+    for (uint8_t i = 0; i < buf[3]; i++)
+        check_sum += buf[4 + i];
+
+    return (check_sum == buf[4 + buf[3]]) ? RF_RX_VALID : RF_RX_INVALID;
+}
+
+/**
+ * @brief Hand a complete frame to uart_receive_pro(), it is dropped if the queue is full.
+ */
+static void rf_rx_push(const rf_rx_frame_t *frame) {
+    chSysLock();
+    if (rf_rx_count < RF_RX_QUEUE_SIZE) {
+        rf_rx_queue[(rf_rx_head + rf_rx_count) % RF_RX_QUEUE_SIZE] = *frame;
+        rf_rx_count++;
+    }
+    chSysUnlock();
+}
+
+/**
+ * @brief Feed one received byte to the frame parser.
+ * @note Bytes are skipped until a header arrives. When a frame turns out to be broken,
+ *       parsing restarts from the next header within it, so a lost byte costs one frame.
+ */
+static void rf_rx_feed(uint8_t byte) {
+    uint8_t pending[UART_MAX_LEN];
+    uint8_t count = 0;
+
+    pending[count++] = byte;
+    for (uint8_t i = 0; i < count;) {
+        byte = pending[i++];
+        if ((rf_rx_frame.len == 0) && (byte != UART_HEAD)) continue;
+
+        rf_rx_frame.buf[rf_rx_frame.len++] = byte;
+        switch (rf_rx_check(&rf_rx_frame)) {
+            case RF_RX_INCOMPLETE:
+                continue;
+
+            case RF_RX_VALID:
+                rf_rx_push(&rf_rx_frame);
+                break;
+
+            case RF_RX_INVALID:
+                // Parse the broken frame again without its header, ahead of the bytes still pending
+                memmove(&pending[rf_rx_frame.len - 1], &pending[i], count - i);
+                memcpy(pending, &rf_rx_frame.buf[1], rf_rx_frame.len - 1);
+                count = rf_rx_frame.len - 1 + count - i;
+                i     = 0;
+                break;
+        }
+        rf_rx_frame.len = 0;
+    }
+}
+
+/**
+ * @brief Receives the bytes of the RF module as soon as the serial driver has them.
+ * @note The thread sleeps in the serial driver until a byte arrives, a frame that
+ *       stays incomplete for RF_RX_TIMEOUT_US is dropped.
+ */
+static THD_WORKING_AREA(rf_rx_thread_wa, RF_RX_THREAD_STACK);
+static THD_FUNCTION(rf_rx_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("rf_rx");
+
+    while (true) {
+        msg_t msg = sdGetTimeout(&SERIAL_DRIVER, TIME_US2I(RF_RX_TIMEOUT_US));
+        if (msg < MSG_OK) {
+            rf_rx_frame.len = 0;
+            continue;
+        }
+        rf_rx_feed((uint8_t)msg);
+    }
+}
+
+/**
+ * @brief Handle the frames received from the RF module.
+ * @note Never waits, the frames were already parsed by rf_rx_thread.
+ */
+void uart_receive_pro(void) {
+    while (rf_rx_count) {
+        rf_rx_frame_t *frame = &rf_rx_queue[rf_rx_head];
+
+        memcpy(Usart_Mgr.RXDBuf, frame->buf, frame->len);
+        Usart_Mgr.RXDLen   = frame->len;
+        Usart_Mgr.RXDState = RX_Done;
+
+        chSysLock();
+        rf_rx_head = (rf_rx_head + 1) % RF_RX_QUEUE_SIZE;
+        rf_rx_count--;
+        chSysUnlock();
+
+        RF_Protocol_Receive();
+    }
+}
+
+/**
+ * @brief Process the RF module replies until a flag is set.
+ * @param flag  flag set by RF_Protocol_Receive()
+ * @param timeout  time to wait in ms
+ * @note Only for rf_device_init(), everything later goes through the link manager.
+ */
+static bool uart_wait_reply(bool *flag, uint16_t timeout) {
+    uint32_t start = timer_read32();
+
+    do {
+        rf_tx_task();
+        uart_receive_pro();
+        if (*flag) return true;
+    } while (timer_elapsed32(start) <= timeout);
+
+    return false;
+}
+
+/**
+ * @brief  RF uart initial.
+ */
+void rf_uart_init(void) {
+    /* set uart buad as 460800 */
+    uart_init(460800);
+
+    /* Enable parity check */
+    USART1->CR1 &= ~((uint32_t)USART_CR1_UE);
+    USART1->CR1 |= USART_CR1_M0 | USART_CR1_PCE;
+    USART1->CR1 |= USART_CR1_UE;
+
+    /* set Rx and Tx pin pull up */
+    GPIOB->OSPEEDR &= ~(GPIO_OSPEEDER_OSPEEDR6 | GPIO_OSPEEDER_OSPEEDR7);
+    GPIOB->PUPDR |= (GPIO_PUPDR_PUPDR6_0 | GPIO_PUPDR_PUPDR7_0);
+
+    chThdCreateStatic(rf_rx_thread_wa, sizeof(rf_rx_thread_wa), NORMALPRIO + 1, rf_rx_thread, NULL);
+}
+
+/**
+ * @brief RF module initial.
+ * @note Runs once at power on and waits for each reply, the dial switch scan that
+ *       follows needs the link settings read back from the module.
+ */
+void rf_device_init(void) {
+    uint8_t timeout = 0;
+
+    timeout      = 10;
+    f_rf_hand_ok = 0;
+    while (timeout--) {
+        wait_ms(20);
+        rf_cmd_send_now(CMD_HAND);
+        if (uart_wait_reply(&f_rf_hand_ok, 5)) break;
+    }
+
+    timeout           = 10;
+    f_rf_read_data_ok = 0;
+    while (timeout--) {
+        wait_ms(20);
+        rf_cmd_send_now(CMD_READ_DATA);
+        if (uart_wait_reply(&f_rf_read_data_ok, 5)) break;
+    }
+
+    timeout          = 10;
+    f_rf_sts_sysc_ok = 0;
+    while (timeout--) {
+        wait_ms(20);
+        rf_cmd_send_now(CMD_RF_STS_SYSC);
+        if (uart_wait_reply(&f_rf_sts_sysc_ok, 5)) break;
+    }
+
+    uart_send_cmd(CMD_SET_NAME, 10, 20);
+}
@@ -0,0 +1,52 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "ansi.h"
+
+/* RF module link shared by the NuPhy Air V2 boards. Each board provides its
+ * ansi.h with the protocol constants and sets RF_DEVICE_NAME in config.h. */
+
+/* Called once a queued command got its reply, or ran out of attempts. */
+typedef void (*rf_cmd_callback_t)(uint8_t cmd, bool acked);
+
+extern USART_MGR_STRUCT Usart_Mgr;
+extern host_driver_t    rf_host_driver;
+extern uint8_t          uart_bit_report_buf[32];
+extern uint16_t         rf_tx_overflow;
+
+extern bool f_uart_ack;
+extern bool f_rf_read_data_ok;
+extern bool f_rf_sts_sysc_ok;
+extern bool f_rf_new_adv_ok;
+extern bool f_rf_reset;
+extern bool f_rf_hand_ok;
+extern bool f_goto_sleep;
+extern bool f_wakeup_prepare;
+
+void    rf_uart_init(void);
+void    rf_device_init(void);
+void    rf_link_start(void);
+void    rf_link_kick(void);
+void    rf_tx_task(void);
+void    uart_receive_pro(void);
+uint8_t rf_cmd_request(uint8_t cmd, bool *reply, uint8_t attempts, uint8_t wait_ack, uint16_t delayms, rf_cmd_callback_t callback);
+uint8_t uart_send_cmd(uint8_t cmd, uint8_t wait_ack, uint16_t delayms);
+void    uart_send_report(uint8_t report_type, uint8_t *report_buf, uint8_t report_size);
+void    uart_send_report_func(void);
+void    uart_send_report_reset(void);
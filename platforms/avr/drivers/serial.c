@@ -359,14 +359,18 @@ static void serial_send_packet(uint8_t *buffer, uint8_t size) {
     }
 }
 
-static uint8_t serial_recive_packet(uint8_t *buffer, uint8_t size) NO_INLINE;
-static uint8_t serial_recive_packet(uint8_t *buffer, uint8_t size) {
+static uint8_t serial_recive_packet(uint8_t *buffer, uint8_t size, bool framed) NO_INLINE;
+static uint8_t serial_recive_packet(uint8_t *buffer, uint8_t size, bool framed) {
     uint8_t pecount = 0;
     for (uint8_t i = 0; i < size; ++i) {
         uint8_t data;
         sync_recv();
         data      = serial_read_chunk(&pecount, 8);
         buffer[i] = data;
+        // framed packets announce their length in the first byte
+        if (framed && i == 0 && data < size) {
+            size = data + 1;
+        }
     }
     return pecount == 0;
 }
@@ -419,13 +423,13 @@ ISR(SERIAL_PIN_INTERRUPT) {
     }
 
     // target send phase
-    if (trans->target2initiator_buffer_size > 0) serial_send_packet((uint8_t *)split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size);
+    if (trans->target2initiator_buffer_size > 0) serial_send_packet((uint8_t *)split_trans_target2initiator_buffer(trans), split_trans_frame_size(trans, split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size));
     // target switch to input
     change_sender2reciver();
 
     // target recive phase
     if (trans->initiator2target_buffer_size > 0) {
-        serial_recive_packet((uint8_t *)split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size);
+        serial_recive_packet((uint8_t *)split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size, trans->framed);
     }
 
     sync_recv(); // weit initiator output to high
@@ -476,7 +480,7 @@ bool soft_serial_transaction(int sstd_index) {
     // initiator recive phase
     // if the target is present syncronize with it
     if (trans->target2initiator_buffer_size > 0) {
-        if (!serial_recive_packet((uint8_t *)split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size)) {
+        if (!serial_recive_packet((uint8_t *)split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size, trans->framed)) {
             serial_output();
             serial_high();
             sei();
@@ -489,7 +493,7 @@ bool soft_serial_transaction(int sstd_index) {
 
     // initiator send phase
     if (trans->initiator2target_buffer_size > 0) {
-        serial_send_packet((uint8_t *)split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size);
+        serial_send_packet((uint8_t *)split_trans_initiator2target_buffer(trans), split_trans_frame_size(trans, split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size));
     }
 
     // always, release the line when not in use
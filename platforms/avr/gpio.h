@@ -36,3 +36,13 @@ typedef uint8_t pin_t;
 #define readPin(pin) ((bool)(PINx_ADDRESS(pin) & _BV((pin)&0xF)))
 
 #define togglePin(pin) (PORTx_ADDRESS(pin) ^= _BV((pin)&0xF))
+
+/* Operation of GPIO by port. */
+
+typedef uint8_t port_t;
+typedef uint8_t port_data_t;
+
+#define getPinPort(pin) ((pin)&0xF0)
+#define getPinPad(pin) ((pin)&0xF)
+
+#define readPort(port) (PINx_ADDRESS(port))
@@ -33,6 +33,10 @@
 
 #include <mcuconf.h>
 
+#ifdef WS2812_DRIVER_AUTO
+#include "ws2812_auto.h"
+#endif
+
 /**
  * @brief   Enables the PAL subsystem.
  */
@@ -168,10 +168,14 @@ void interrupt_handler(void *arg) {
     sync_send();
 
     split_transaction_desc_t *trans = &split_transaction_table[sstd_index];
-    for (int i = 0; i < trans->initiator2target_buffer_size; ++i) {
+    uint8_t                   size  = trans->initiator2target_buffer_size;
+    for (int i = 0; i < size; ++i) {
         split_trans_initiator2target_buffer(trans)[i] = serial_read_byte();
         sync_send();
         checksum_computed += split_trans_initiator2target_buffer(trans)[i];
+        if (i == 0) {
+            size = split_trans_frame_size(trans, split_trans_initiator2target_buffer(trans), size);
+        }
     }
     checksum_computed ^= 7;
 
@@ -187,7 +191,8 @@ void interrupt_handler(void *arg) {
     }
 
     uint8_t checksum = 0;
-    for (int i = 0; i < trans->target2initiator_buffer_size; ++i) {
+    size             = split_trans_frame_size(trans, split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size);
+    for (int i = 0; i < size; ++i) {
         serial_write_byte(split_trans_target2initiator_buffer(trans)[i]);
         sync_send();
         serial_delay_half();
@@ -245,7 +250,8 @@ static inline bool initiate_transaction(uint8_t sstd_index) {
     serial_write_byte(sstd_index); // first chunk is transaction id
     sync_recv();
 
-    for (int i = 0; i < trans->initiator2target_buffer_size; ++i) {
+    uint8_t size = split_trans_frame_size(trans, split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size);
+    for (int i = 0; i < size; ++i) {
         serial_write_byte(split_trans_initiator2target_buffer(trans)[i]);
         sync_recv();
         checksum += split_trans_initiator2target_buffer(trans)[i];
@@ -258,10 +264,14 @@ static inline bool initiate_transaction(uint8_t sstd_index) {
 
     // receive data from the slave
     uint8_t checksum_computed = 0;
-    for (int i = 0; i < trans->target2initiator_buffer_size; ++i) {
+    size                      = trans->target2initiator_buffer_size;
+    for (int i = 0; i < size; ++i) {
         split_trans_target2initiator_buffer(trans)[i] = serial_read_byte();
         sync_recv();
         checksum_computed += split_trans_target2initiator_buffer(trans)[i];
+        if (i == 0) {
+            size = split_trans_frame_size(trans, split_trans_target2initiator_buffer(trans), size);
+        }
     }
     checksum_computed ^= 7;
     uint8_t checksum_received = serial_read_byte();
@@ -0,0 +1,121 @@
+/* Copyright 2023 QMK
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * Resolves `WS2812_DRIVER = auto`. Included by halconf.h right after mcuconf.h, so the
+ * timers the keyboard already uses are known and the chosen one can still be enabled.
+ *
+ * common_features.mk passes up to three timer channels that can drive WS2812_DI_PIN,
+ * taken from WS2812_PWM_CANDIDATES in mcu_selection.mk, as WS2812_AUTO_<n>_*. The first
+ * one on a free timer selects the PWM driver; if every timer is taken, the bitbang
+ * driver is used.
+ */
+
+#define WS2812_AUTO_RESOLVED
+
+#define WS2812_AUTO_TIMER_USED(n) WS2812_AUTO_TIMER_USED_(n)
+#define WS2812_AUTO_TIMER_USED_(n) WS2812_AUTO_TIM##n##_USED
+
+#if (defined(STM32_PWM_USE_TIM1) && STM32_PWM_USE_TIM1) || (defined(STM32_GPT_USE_TIM1) && STM32_GPT_USE_TIM1) || (defined(STM32_ICU_USE_TIM1) && STM32_ICU_USE_TIM1) || (defined(STM32_ST_USE_TIMER) && STM32_ST_USE_TIMER == 1)
+#    define WS2812_AUTO_TIM1_USED 1
+#else
+#    define WS2812_AUTO_TIM1_USED 0
+#endif
+#if (defined(STM32_PWM_USE_TIM2) && STM32_PWM_USE_TIM2) || (defined(STM32_GPT_USE_TIM2) && STM32_GPT_USE_TIM2) || (defined(STM32_ICU_USE_TIM2) && STM32_ICU_USE_TIM2) || (defined(STM32_ST_USE_TIMER) && STM32_ST_USE_TIMER == 2)
+#    define WS2812_AUTO_TIM2_USED 1
+#else
+#    define WS2812_AUTO_TIM2_USED 0
+#endif
+#if (defined(STM32_PWM_USE_TIM3) && STM32_PWM_USE_TIM3) || (defined(STM32_GPT_USE_TIM3) && STM32_GPT_USE_TIM3) || (defined(STM32_ICU_USE_TIM3) && STM32_ICU_USE_TIM3) || (defined(STM32_ST_USE_TIMER) && STM32_ST_USE_TIMER == 3)
+#    define WS2812_AUTO_TIM3_USED 1
+#else
+#    define WS2812_AUTO_TIM3_USED 0
+#endif
+#if (defined(STM32_PWM_USE_TIM4) && STM32_PWM_USE_TIM4) || (defined(STM32_GPT_USE_TIM4) && STM32_GPT_USE_TIM4) || (defined(STM32_ICU_USE_TIM4) && STM32_ICU_USE_TIM4) || (defined(STM32_ST_USE_TIMER) && STM32_ST_USE_TIMER == 4)
+#    define WS2812_AUTO_TIM4_USED 1
+#else
+#    define WS2812_AUTO_TIM4_USED 0
+#endif
+#if (defined(STM32_PWM_USE_TIM5) && STM32_PWM_USE_TIM5) || (defined(STM32_GPT_USE_TIM5) && STM32_GPT_USE_TIM5) || (defined(STM32_ICU_USE_TIM5) && STM32_ICU_USE_TIM5) || (defined(STM32_ST_USE_TIMER) && STM32_ST_USE_TIMER == 5)
+#    define WS2812_AUTO_TIM5_USED 1
+#else
+#    define WS2812_AUTO_TIM5_USED 0
+#endif
+
+#if defined(WS2812_AUTO_1_TIMER) && !WS2812_AUTO_TIMER_USED(WS2812_AUTO_1_TIMER)
+#    define WS2812_AUTO_TIMER WS2812_AUTO_1_TIMER
+#    define WS2812_PWM_CHANNEL WS2812_AUTO_1_CHANNEL
+#    define WS2812_PWM_PAL_MODE WS2812_AUTO_1_PAL_MODE
+#    define WS2812_DMA_STREAM WS2812_AUTO_1_DMA_STREAM
+#    define WS2812_DMA_CHANNEL WS2812_AUTO_1_DMA_CHANNEL
+#    define WS2812_AUTO_COMPLEMENTARY WS2812_AUTO_1_COMPLEMENTARY
+#elif defined(WS2812_AUTO_2_TIMER) && !WS2812_AUTO_TIMER_USED(WS2812_AUTO_2_TIMER)
+#    define WS2812_AUTO_TIMER WS2812_AUTO_2_TIMER
+#    define WS2812_PWM_CHANNEL WS2812_AUTO_2_CHANNEL
+#    define WS2812_PWM_PAL_MODE WS2812_AUTO_2_PAL_MODE
+#    define WS2812_DMA_STREAM WS2812_AUTO_2_DMA_STREAM
+#    define WS2812_DMA_CHANNEL WS2812_AUTO_2_DMA_CHANNEL
+#    define WS2812_AUTO_COMPLEMENTARY WS2812_AUTO_2_COMPLEMENTARY
+#elif defined(WS2812_AUTO_3_TIMER) && !WS2812_AUTO_TIMER_USED(WS2812_AUTO_3_TIMER)
+#    define WS2812_AUTO_TIMER WS2812_AUTO_3_TIMER
+#    define WS2812_PWM_CHANNEL WS2812_AUTO_3_CHANNEL
+#    define WS2812_PWM_PAL_MODE WS2812_AUTO_3_PAL_MODE
+#    define WS2812_DMA_STREAM WS2812_AUTO_3_DMA_STREAM
+#    define WS2812_DMA_CHANNEL WS2812_AUTO_3_DMA_CHANNEL
+#    define WS2812_AUTO_COMPLEMENTARY WS2812_AUTO_3_COMPLEMENTARY
+#endif
+
+#ifndef WS2812_AUTO_TIMER
+#    define WS2812_DRIVER_BITBANG
+#else
+#    define WS2812_DRIVER_PWM
+
+#    if !defined(HAL_USE_PWM)
+#        define HAL_USE_PWM TRUE
+#    endif
+
+#    if WS2812_AUTO_COMPLEMENTARY
+#        define WS2812_PWM_COMPLEMENTARY_OUTPUT
+#        undef STM32_PWM_USE_ADVANCED
+#        define STM32_PWM_USE_ADVANCED TRUE
+#    endif
+
+#    if WS2812_AUTO_TIMER == 1
+#        define WS2812_PWM_DRIVER PWMD1
+#        undef STM32_PWM_USE_TIM1
+#        define STM32_PWM_USE_TIM1 TRUE
+#    elif WS2812_AUTO_TIMER == 2
+#        define WS2812_PWM_DRIVER PWMD2
+#        undef STM32_PWM_USE_TIM2
+#        define STM32_PWM_USE_TIM2 TRUE
+#    elif WS2812_AUTO_TIMER == 3
+#        define WS2812_PWM_DRIVER PWMD3
+#        undef STM32_PWM_USE_TIM3
+#        define STM32_PWM_USE_TIM3 TRUE
+#    elif WS2812_AUTO_TIMER == 4
+#        define WS2812_PWM_DRIVER PWMD4
+#        undef STM32_PWM_USE_TIM4
+#        define STM32_PWM_USE_TIM4 TRUE
+#    elif WS2812_AUTO_TIMER == 5
+#        define WS2812_PWM_DRIVER PWMD5
+#        undef STM32_PWM_USE_TIM5
+#        define STM32_PWM_USE_TIM5 TRUE
+#    else
+#        error "WS2812_DRIVER = auto: unsupported timer in WS2812_PWM_CANDIDATES"
+#    endif
+#endif
@@ -1,8 +1,12 @@
 #include "ws2812.h"
+#include "ws2812_chain.h"
 
 #include "gpio.h"
 #include "chibios_config.h"
 
+// Also built for WS2812_DRIVER = auto, where ws2812_auto.h picks the driver
+#if defined(WS2812_DRIVER_BITBANG)
+
 /* Adapted from https://github.com/bigjosh/SimpleNeoPixelDemo/ */
 
 #ifndef NOP_FUDGE
@@ -46,60 +50,73 @@
         }                                           \
     } while (0)
 
-void sendByte(uint8_t byte) {
+void sendByte(ioportid_t port, ioportmask_t mask, uint8_t byte) {
     // WS2812 protocol wants most significant bits first
     for (unsigned char bit = 0; bit < 8; bit++) {
         bool is_one = byte & (1 << (7 - bit));
         // using something like wait_ns(is_one ? T1L : T0L) here throws off timings
         if (is_one) {
             // 1
-            writePinHigh(WS2812_DI_PIN);
+            palSetPort(port, mask);
             wait_ns(WS2812_T1H);
-            writePinLow(WS2812_DI_PIN);
+            palClearPort(port, mask);
             wait_ns(WS2812_T1L);
         } else {
             // 0
-            writePinHigh(WS2812_DI_PIN);
+            palSetPort(port, mask);
             wait_ns(WS2812_T0H);
-            writePinLow(WS2812_DI_PIN);
+            palClearPort(port, mask);
             wait_ns(WS2812_T0L);
         }
     }
 }
 
+static ws2812_chain_t ws2812_default_chain = {
+    .pin = WS2812_DI_PIN,
+#ifdef WS2812_LED_COUNT
+    .led_count = WS2812_LED_COUNT,
+#endif
+};
+
+void ws2812_chain_init(ws2812_chain_t *chain) {
+    palSetLineMode(chain->pin, WS2812_OUTPUT_MODE);
+    chain->initialized = true;
+}
+
 void ws2812_init(void) {
-    palSetLineMode(WS2812_DI_PIN, WS2812_OUTPUT_MODE);
+    ws2812_chain_init(&ws2812_default_chain);
 }
 
-// Setleds for standard RGB
-void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
-    static bool s_init = false;
-    if (!s_init) {
-        ws2812_init();
-        s_init = true;
+static void ws2812_chain_write(ws2812_chain_t *chain, LED_TYPE *ledarray, uint16_t leds) {
+    if (!chain->initialized) {
+        ws2812_chain_init(chain);
     }
 
+    // resolve the port once, setting and clearing it must cost the same as with a constant pin
+    ioportid_t   port = PAL_PORT(chain->pin);
+    ioportmask_t mask = PAL_PORT_BIT(PAL_PAD(chain->pin));
+
     // this code is very time dependent, so we need to disable interrupts
     chSysLock();
 
-    for (uint8_t i = 0; i < leds; i++) {
+    for (uint16_t i = 0; i < leds; i++) {
         // WS2812 protocol dictates grb order
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
-        sendByte(ledarray[i].g);
-        sendByte(ledarray[i].r);
-        sendByte(ledarray[i].b);
+        sendByte(port, mask, ledarray[i].g);
+        sendByte(port, mask, ledarray[i].r);
+        sendByte(port, mask, ledarray[i].b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
-        sendByte(ledarray[i].r);
-        sendByte(ledarray[i].g);
-        sendByte(ledarray[i].b);
+        sendByte(port, mask, ledarray[i].r);
+        sendByte(port, mask, ledarray[i].g);
+        sendByte(port, mask, ledarray[i].b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
-        sendByte(ledarray[i].b);
-        sendByte(ledarray[i].g);
-        sendByte(ledarray[i].r);
+        sendByte(port, mask, ledarray[i].b);
+        sendByte(port, mask, ledarray[i].g);
+        sendByte(port, mask, ledarray[i].r);
 #endif
 
 #ifdef RGBW
-        sendByte(ledarray[i].w);
+        sendByte(port, mask, ledarray[i].w);
 #endif
     }
 
@@ -107,3 +124,20 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
 
     chSysUnlock();
 }
+
+bool ws2812_chain_flush(ws2812_chain_t *chain) {
+    if (!chain->dirty) {
+        return true;
+    }
+
+    ws2812_chain_write(chain, chain->leds, chain->led_count);
+    chain->dirty = false;
+    return true;
+}
+
+// Setleds for standard RGB
+void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
+    ws2812_chain_write(&ws2812_default_chain, ledarray, leds);
+}
+
+#endif
@@ -0,0 +1,29 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "ws2812_chain.h"
+
+void ws2812_chain_set_color(ws2812_chain_t *chain, uint16_t index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (index >= chain->led_count) {
+        return;
+    }
+
+    LED_TYPE *led = &chain->leds[index];
+    if (led->r == red && led->g == green && led->b == blue) {
+        return;
+    }
+
+    led->r = red;
+    led->g = green;
+    led->b = blue;
+#ifdef RGBW
+    convert_rgb_to_rgbw(led);
+#endif
+    chain->dirty = true;
+}
+
+void ws2812_chain_set_color_all(ws2812_chain_t *chain, uint8_t red, uint8_t green, uint8_t blue) {
+    for (uint16_t i = 0; i < chain->led_count; i++) {
+        ws2812_chain_set_color(chain, i, red, green, blue);
+    }
+}
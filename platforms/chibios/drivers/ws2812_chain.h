@@ -0,0 +1,149 @@
+/* Copyright 2023 QMK
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <hal.h>
+
+#include "gpio.h"
+#include "chibios_config.h"
+#include "ws2812.h"
+
+// A halconf.h that doesn't #include_next <halconf.h> never runs ws2812_auto.h, use bitbang then
+#if defined(WS2812_DRIVER_AUTO) && !defined(WS2812_AUTO_RESOLVED)
+#    define WS2812_DRIVER_BITBANG
+#endif
+
+/*
+ * A chain is one independent string of WS2812 LEDs on its own data pin, driven by the
+ * WS2812_DRIVER selected in rules.mk. `ws2812_setleds()` drives the chain configured with
+ * the WS2812_* defines; further chains are declared by the keyboard with their own pin,
+ * timer or SPI peripheral, DMA stream and buffers.
+ */
+
+#ifdef RGBW
+#    define WS2812_CHAIN_CHANNELS 4
+#else
+#    define WS2812_CHAIN_CHANNELS 3
+#endif
+
+#if defined(WS2812_DRIVER_PWM)
+#    ifndef WS2812_PWM_DRIVER
+#        define WS2812_PWM_DRIVER PWMD2 // TIMx
+#    endif
+
+/* Summarize https://www.st.com/resource/en/application_note/an4013-stm32-crossseries-timer-overview-stmicroelectronics.pdf to
+ * figure out if we are using a 32bit timer. This is needed to setup the DMA controller correctly.
+ * Ignore STM32H7XX and STM32U5XX as they are not supported by ChibiOS.
+ */
+#    if !defined(STM32F1XX) && !defined(STM32L0XX) && !defined(STM32L1XX)
+#        define WS2812_PWM_TIMER_32BIT_PWMD2 1
+#    endif
+#    if !defined(STM32F1XX)
+#        define WS2812_PWM_TIMER_32BIT_PWMD5 1
+#    endif
+#    define WS2812_CONCAT1(a, b) a##b
+#    define WS2812_CONCAT(a, b) WS2812_CONCAT1(a, b)
+#    if WS2812_CONCAT(WS2812_PWM_TIMER_32BIT_, WS2812_PWM_DRIVER)
+#        define WS2812_PWM_TIMER_32BIT
+#    endif
+
+// STM32F2XX, STM32F4XX and STM32F7XX do NOT zero pad DMA transfers of unequal data width. Buffer width must match TIMx CCR.
+// The width follows WS2812_PWM_DRIVER, so further chains have to use timers of the same width.
+#    if defined(STM32F2XX) || defined(STM32F4XX) || defined(STM32F7XX)
+#        if defined(WS2812_PWM_TIMER_32BIT)
+typedef uint32_t ws2812_buffer_t;
+#        else
+typedef uint16_t ws2812_buffer_t;
+#        endif
+#    else
+typedef uint8_t ws2812_buffer_t;
+#    endif
+#    if defined(WB32F3G71xx) || defined(WB32FQ95xx)
+typedef wb32_dma_stream_t ws2812_dma_stream_t;
+#    else
+typedef stm32_dma_stream_t ws2812_dma_stream_t;
+#    endif
+
+/** @brief Number of `ws2812_buffer_t` entries a PWM chain of `leds` LEDs needs: one per bit plus the reset period. */
+#    define WS2812_CHAIN_BUFFER_SIZE(leds) ((leds)*WS2812_CHAIN_CHANNELS * 8 + 1000 * WS2812_TRST_US / WS2812_TIMING + 1)
+#elif defined(WS2812_DRIVER_SPI)
+typedef uint8_t ws2812_buffer_t;
+
+/** @brief Number of bytes an SPI chain of `leds` LEDs needs: preamble, four bytes per color byte and the reset period. */
+#    define WS2812_CHAIN_BUFFER_SIZE(leds) (4 + (leds)*WS2812_CHAIN_CHANNELS * 4 + 1000 * WS2812_TRST_US / (2 * WS2812_TIMING))
+#else
+typedef uint8_t ws2812_buffer_t;
+
+/** @brief The bitbang driver sends straight from `leds` and does not need a frame buffer. */
+#    define WS2812_CHAIN_BUFFER_SIZE(leds) 0
+#endif
+
+typedef struct {
+    pin_t     pin;       /**< Data pin. For SPI this is the MOSI pin. */
+    uint16_t  led_count; /**< Number of LEDs on the chain. */
+    LED_TYPE *leds;      /**< Colors set with `ws2812_chain_set_color()`, `led_count` entries. */
+#if defined(WS2812_DRIVER_PWM)
+    PWMDriver                 *pwm_driver;  /**< Timer, e.g. `&PWMD2`, as wide as `WS2812_PWM_DRIVER`. */
+    uint8_t                    pwm_channel; /**< Timer channel, starting at 1. */
+    uint8_t                    pal_mode;    /**< Alternate function of `pin` for the timer channel. */
+    const ws2812_dma_stream_t *dma_stream;  /**< DMA stream for TIMx_UP. */
+    uint8_t                    dma_channel; /**< DMA channel for TIMx_UP. */
+#    if (STM32_DMA_SUPPORTS_DMAMUX == TRUE)
+    uint8_t dmamux_id; /**< DMAMUX request for TIMx_UP. */
+#    endif
+    ws2812_buffer_t *buffer;     /**< Frame buffer, `WS2812_CHAIN_BUFFER_SIZE(led_count)` entries. */
+    PWMConfig        pwm_config; /**< Filled in by `ws2812_chain_init()`. */
+#elif defined(WS2812_DRIVER_SPI)
+    SPIDriver       *spi_driver;   /**< SPI peripheral, e.g. `&SPID1`. */
+    uint8_t          pal_mode;     /**< Alternate function of `pin` for MOSI. */
+    pin_t            sck_pin;      /**< SCK pin if the MCU needs it configured, `NO_PIN` otherwise. */
+    uint8_t          sck_pal_mode; /**< Alternate function of `sck_pin`. */
+    ws2812_buffer_t *buffer;       /**< Frame buffer, `WS2812_CHAIN_BUFFER_SIZE(led_count)` bytes. */
+    SPIConfig        spi_config;   /**< Filled in by `ws2812_chain_init()`. */
+#endif
+    bool initialized;
+    bool dirty;
+} ws2812_chain_t;
+
+/**
+ * @brief Configures the pin and the peripherals of the chain. Called on first use if needed.
+ */
+void ws2812_chain_init(ws2812_chain_t *chain);
+
+/**
+ * @brief Sets the color of one LED of the chain, marking the chain dirty if it changed.
+ */
+void ws2812_chain_set_color(ws2812_chain_t *chain, uint16_t index, uint8_t red, uint8_t green, uint8_t blue);
+
+/**
+ * @brief Sets the color of every LED of the chain, marking the chain dirty if any changed.
+ */
+void ws2812_chain_set_color_all(ws2812_chain_t *chain, uint8_t red, uint8_t green, uint8_t blue);
+
+/**
+ * @brief Sends the colors of a dirty chain to the LEDs.
+ *
+ * Nothing is done while the chain is clean, so static strips cost no time. The PWM and SPI
+ * drivers only encode the frame buffer and hand it to DMA; the bitbang driver sends the frame
+ * with interrupts disabled.
+ *
+ * @return false if the peripheral was still busy with the previous frame; the chain stays dirty.
+ */
+bool ws2812_chain_flush(ws2812_chain_t *chain);
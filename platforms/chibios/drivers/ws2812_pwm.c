@@ -1,7 +1,11 @@
 #include "ws2812.h"
+#include "ws2812_chain.h"
 #include "gpio.h"
 #include "chibios_config.h"
 
+// Also built for WS2812_DRIVER = auto, where ws2812_auto.h picks the driver
+#if defined(WS2812_DRIVER_PWM)
+
 /* Adapted from https://github.com/joewa/WS2812-LED-Driver_ChibiOS/ */
 
 #ifdef RGBW
@@ -10,9 +14,6 @@
 #    define WS2812_CHANNELS 3
 #endif
 
-#ifndef WS2812_PWM_DRIVER
-#    define WS2812_PWM_DRIVER PWMD2 // TIMx
-#endif
 #ifndef WS2812_PWM_CHANNEL
 #    define WS2812_PWM_CHANNEL 2 // Channel
 #endif
@@ -29,22 +30,6 @@
 #    error "please consult your MCU's datasheet and specify in your config.h: #define WS2812_DMAMUX_ID STM32_DMAMUX1_TIM?_UP"
 #endif
 
-/* Summarize https://www.st.com/resource/en/application_note/an4013-stm32-crossseries-timer-overview-stmicroelectronics.pdf to
- * figure out if we are using a 32bit timer. This is needed to setup the DMA controller correctly.
- * Ignore STM32H7XX and STM32U5XX as they are not supported by ChibiOS.
- */
-#if !defined(STM32F1XX) && !defined(STM32L0XX) && !defined(STM32L1XX)
-#    define WS2812_PWM_TIMER_32BIT_PWMD2 1
-#endif
-#if !defined(STM32F1XX)
-#    define WS2812_PWM_TIMER_32BIT_PWMD5 1
-#endif
-#define WS2812_CONCAT1(a, b) a##b
-#define WS2812_CONCAT(a, b) WS2812_CONCAT1(a, b)
-#if WS2812_CONCAT(WS2812_PWM_TIMER_32BIT_, WS2812_PWM_DRIVER)
-#    define WS2812_PWM_TIMER_32BIT
-#endif
-
 #ifndef WS2812_PWM_COMPLEMENTARY_OUTPUT
 #    define WS2812_PWM_OUTPUT_MODE PWM_OUTPUT_ACTIVE_HIGH
 #else
@@ -58,15 +43,15 @@
 // Default Push Pull
 #ifndef WS2812_EXTERNAL_PULLUP
 #    if defined(USE_GPIOV1)
-#        define WS2812_OUTPUT_MODE PAL_MODE_ALTERNATE_PUSHPULL
+#        define WS2812_OUTPUT_MODE(pal_mode) PAL_MODE_ALTERNATE_PUSHPULL
 #    else
-#        define WS2812_OUTPUT_MODE PAL_MODE_ALTERNATE(WS2812_PWM_PAL_MODE) | PAL_OUTPUT_TYPE_PUSHPULL | PAL_OUTPUT_SPEED_HIGHEST | PAL_PUPDR_FLOATING
+#        define WS2812_OUTPUT_MODE(pal_mode) PAL_MODE_ALTERNATE(pal_mode) | PAL_OUTPUT_TYPE_PUSHPULL | PAL_OUTPUT_SPEED_HIGHEST | PAL_PUPDR_FLOATING
 #    endif
 #else
 #    if defined(USE_GPIOV1)
-#        define WS2812_OUTPUT_MODE PAL_MODE_ALTERNATE_OPENDRAIN
+#        define WS2812_OUTPUT_MODE(pal_mode) PAL_MODE_ALTERNATE_OPENDRAIN
 #    else
-#        define WS2812_OUTPUT_MODE PAL_MODE_ALTERNATE(WS2812_PWM_PAL_MODE) | PAL_OUTPUT_TYPE_OPENDRAIN | PAL_OUTPUT_SPEED_HIGHEST | PAL_PUPDR_FLOATING
+#        define WS2812_OUTPUT_MODE(pal_mode) PAL_MODE_ALTERNATE(pal_mode) | PAL_OUTPUT_TYPE_OPENDRAIN | PAL_OUTPUT_SPEED_HIGHEST | PAL_PUPDR_FLOATING
 #    endif
 #endif
 
@@ -88,8 +73,8 @@
  */
 #define WS2812_COLOR_BITS (WS2812_CHANNELS * 8)
 #define WS2812_RESET_BIT_N (1000 * WS2812_TRST_US / WS2812_TIMING)
-#define WS2812_COLOR_BIT_N (WS2812_LED_COUNT * WS2812_COLOR_BITS) /**< Number of data bits */
-#define WS2812_BIT_N (WS2812_COLOR_BIT_N + WS2812_RESET_BIT_N)    /**< Total number of bits in a frame */
+#define WS2812_COLOR_BIT_N(leds) ((leds)*WS2812_COLOR_BITS)                  /**< Number of data bits */
+#define WS2812_BIT_N(leds) (WS2812_COLOR_BIT_N(leds) + WS2812_RESET_BIT_N) /**< Total number of bits in a frame */
 
 /**
  * @brief   High period for a zero, in ticks
@@ -271,15 +256,14 @@
 
 // STM32F2XX, STM32F4XX and STM32F7XX do NOT zero pad DMA transfers of unequal data width. Buffer width must match TIMx CCR.
 // For all other STM32 DMA transfer will automatically zero pad. We only need to set the right peripheral width.
+// ws2812_buffer_t is picked to match in ws2812_chain.h.
 #if defined(STM32F2XX) || defined(STM32F4XX) || defined(STM32F7XX)
 #    if defined(WS2812_PWM_TIMER_32BIT)
 #        define WS2812_DMA_MEMORY_WIDTH STM32_DMA_CR_MSIZE_WORD
 #        define WS2812_DMA_PERIPHERAL_WIDTH STM32_DMA_CR_PSIZE_WORD
-typedef uint32_t ws2812_buffer_t;
 #    else
 #        define WS2812_DMA_MEMORY_WIDTH STM32_DMA_CR_MSIZE_HWORD
 #        define WS2812_DMA_PERIPHERAL_WIDTH STM32_DMA_CR_PSIZE_HWORD
-typedef uint16_t ws2812_buffer_t;
 #    endif
 #else
 #    define WS2812_DMA_MEMORY_WIDTH STM32_DMA_CR_MSIZE_BYTE
@@ -288,10 +272,23 @@ typedef uint16_t ws2812_buffer_t;
 #    else
 #        define WS2812_DMA_PERIPHERAL_WIDTH STM32_DMA_CR_PSIZE_HWORD
 #    endif
-typedef uint8_t ws2812_buffer_t;
 #endif
 
-static ws2812_buffer_t ws2812_frame_buffer[WS2812_BIT_N + 1]; /**< Buffer for a frame */
+static ws2812_buffer_t ws2812_frame_buffer[WS2812_CHAIN_BUFFER_SIZE(WS2812_LED_COUNT)]; /**< Buffer for a frame */
+
+static ws2812_chain_t ws2812_default_chain = {
+    .pin         = WS2812_DI_PIN,
+    .led_count   = WS2812_LED_COUNT,
+    .pwm_driver  = &WS2812_PWM_DRIVER,
+    .pwm_channel = WS2812_PWM_CHANNEL,
+    .pal_mode    = WS2812_PWM_PAL_MODE,
+    .dma_stream  = WS2812_DMA_STREAM,
+    .dma_channel = WS2812_DMA_CHANNEL,
+#if (STM32_DMA_SUPPORTS_DMAMUX == TRUE)
+    .dmamux_id = WS2812_DMAMUX_ID,
+#endif
+    .buffer = ws2812_frame_buffer,
+};
 
 /* --- PUBLIC FUNCTIONS ----------------------------------------------------- */
 /*
@@ -300,97 +297,115 @@ static ws2812_buffer_t ws2812_frame_buffer[WS2812_BIT_N + 1]; /**< Buffer for a
  * write/read to/from the other buffer).
  */
 
-void ws2812_init(void) {
+void ws2812_chain_init(ws2812_chain_t *chain) {
     // Initialize led frame buffer
     uint32_t i;
-    for (i = 0; i < WS2812_COLOR_BIT_N; i++)
-        ws2812_frame_buffer[i] = WS2812_DUTYCYCLE_0; // All color bits are zero duty cycle
+    for (i = 0; i < WS2812_COLOR_BIT_N(chain->led_count); i++)
+        chain->buffer[i] = WS2812_DUTYCYCLE_0; // All color bits are zero duty cycle
     for (i = 0; i < WS2812_RESET_BIT_N; i++)
-        ws2812_frame_buffer[i + WS2812_COLOR_BIT_N] = 0; // All reset bits are zero
+        chain->buffer[i + WS2812_COLOR_BIT_N(chain->led_count)] = 0; // All reset bits are zero
 
-    palSetLineMode(WS2812_DI_PIN, WS2812_OUTPUT_MODE);
+    palSetLineMode(chain->pin, WS2812_OUTPUT_MODE(chain->pal_mode));
 
     // PWM Configuration
-    //#pragma GCC diagnostic ignored "-Woverride-init"  // Turn off override-init warning for this struct. We use the overriding ability to set a "default" channel config
-    static const PWMConfig ws2812_pwm_config = {
+    chain->pwm_config = (PWMConfig){
         .frequency = WS2812_PWM_FREQUENCY,
         .period    = WS2812_PWM_PERIOD, // Mit dieser Periode wird UDE-Event erzeugt und ein neuer Wert (Länge WS2812_BIT_N) vom DMA ins CCR geschrieben
         .callback  = NULL,
-        .channels =
-            {
-                [0 ... 3]                = {.mode = PWM_OUTPUT_DISABLED, .callback = NULL},    // Channels default to disabled
-                [WS2812_PWM_CHANNEL - 1] = {.mode = WS2812_PWM_OUTPUT_MODE, .callback = NULL}, // Turn on the channel we care about
-            },
-        .cr2  = 0,
-        .dier = TIM_DIER_UDE, // DMA on update event for next period
+        .cr2       = 0,
+        .dier      = TIM_DIER_UDE, // DMA on update event for next period
     };
-    //#pragma GCC diagnostic pop  // Restore command-line warning options
+    for (i = 0; i < ARRAY_SIZE(chain->pwm_config.channels); i++) {
+        chain->pwm_config.channels[i].mode     = PWM_OUTPUT_DISABLED; // Channels default to disabled
+        chain->pwm_config.channels[i].callback = NULL;
+    }
+    chain->pwm_config.channels[chain->pwm_channel - 1].mode = WS2812_PWM_OUTPUT_MODE; // Turn on the channel we care about
 
     // Configure DMA
     // dmaInit(); // Joe added this
 #if defined(WB32F3G71xx) || defined(WB32FQ95xx)
-    dmaStreamAlloc(WS2812_DMA_STREAM - WB32_DMA_STREAM(0), 10, NULL, NULL);
-    dmaStreamSetSource(WS2812_DMA_STREAM, ws2812_frame_buffer);
-    dmaStreamSetDestination(WS2812_DMA_STREAM, &(WS2812_PWM_DRIVER.tim->CCR[WS2812_PWM_CHANNEL - 1])); // Ziel ist der An-Zeit im Cap-Comp-Register
-    dmaStreamSetMode(WS2812_DMA_STREAM, WB32_DMA_CHCFG_HWHIF(WS2812_DMA_CHANNEL) | WB32_DMA_CHCFG_DIR_M2P | WB32_DMA_CHCFG_PSIZE_WORD | WB32_DMA_CHCFG_MSIZE_WORD | WB32_DMA_CHCFG_MINC | WB32_DMA_CHCFG_CIRC | WB32_DMA_CHCFG_TCIE | WB32_DMA_CHCFG_PL(3));
+    dmaStreamAlloc(chain->dma_stream - WB32_DMA_STREAM(0), 10, NULL, NULL);
+    dmaStreamSetSource(chain->dma_stream, chain->buffer);
+    dmaStreamSetDestination(chain->dma_stream, &(chain->pwm_driver->tim->CCR[chain->pwm_channel - 1])); // Ziel ist der An-Zeit im Cap-Comp-Register
+    dmaStreamSetMode(chain->dma_stream, WB32_DMA_CHCFG_HWHIF(chain->dma_channel) | WB32_DMA_CHCFG_DIR_M2P | WB32_DMA_CHCFG_PSIZE_WORD | WB32_DMA_CHCFG_MSIZE_WORD | WB32_DMA_CHCFG_MINC | WB32_DMA_CHCFG_CIRC | WB32_DMA_CHCFG_TCIE | WB32_DMA_CHCFG_PL(3));
 #else
-    dmaStreamAlloc(WS2812_DMA_STREAM - STM32_DMA_STREAM(0), 10, NULL, NULL);
-    dmaStreamSetPeripheral(WS2812_DMA_STREAM, &(WS2812_PWM_DRIVER.tim->CCR[WS2812_PWM_CHANNEL - 1])); // Ziel ist der An-Zeit im Cap-Comp-Register
-    dmaStreamSetMemory0(WS2812_DMA_STREAM, ws2812_frame_buffer);
-    dmaStreamSetMode(WS2812_DMA_STREAM, STM32_DMA_CR_CHSEL(WS2812_DMA_CHANNEL) | STM32_DMA_CR_DIR_M2P | WS2812_DMA_PERIPHERAL_WIDTH | WS2812_DMA_MEMORY_WIDTH | STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC | STM32_DMA_CR_PL(3));
+    dmaStreamAlloc(chain->dma_stream - STM32_DMA_STREAM(0), 10, NULL, NULL);
+    dmaStreamSetPeripheral(chain->dma_stream, &(chain->pwm_driver->tim->CCR[chain->pwm_channel - 1])); // Ziel ist der An-Zeit im Cap-Comp-Register
+    dmaStreamSetMemory0(chain->dma_stream, chain->buffer);
+    dmaStreamSetMode(chain->dma_stream, STM32_DMA_CR_CHSEL(chain->dma_channel) | STM32_DMA_CR_DIR_M2P | WS2812_DMA_PERIPHERAL_WIDTH | WS2812_DMA_MEMORY_WIDTH | STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC | STM32_DMA_CR_PL(3));
 #endif
-    dmaStreamSetTransactionSize(WS2812_DMA_STREAM, WS2812_BIT_N);
+    dmaStreamSetTransactionSize(chain->dma_stream, WS2812_BIT_N(chain->led_count));
     // M2P: Memory 2 Periph; PL: Priority Level
 
 #if (STM32_DMA_SUPPORTS_DMAMUX == TRUE)
     // If the MCU has a DMAMUX we need to assign the correct resource
-    dmaSetRequestSource(WS2812_DMA_STREAM, WS2812_DMAMUX_ID);
+    dmaSetRequestSource(chain->dma_stream, chain->dmamux_id);
 #endif
 
     // Start DMA
-    dmaStreamEnable(WS2812_DMA_STREAM);
+    dmaStreamEnable(chain->dma_stream);
 
     // Configure PWM
     // NOTE: It's required that preload be enabled on the timer channel CCR register. This is currently enabled in the
     // ChibiOS driver code, so we don't have to do anything special to the timer. If we did, we'd have to start the timer,
     // disable counting, enable the channel, and then make whatever configuration changes we need.
-    pwmStart(&WS2812_PWM_DRIVER, &ws2812_pwm_config);
-    pwmEnableChannel(&WS2812_PWM_DRIVER, WS2812_PWM_CHANNEL - 1, 0); // Initial period is 0; output will be low until first duty cycle is DMA'd in
+    pwmStart(chain->pwm_driver, &chain->pwm_config);
+    pwmEnableChannel(chain->pwm_driver, chain->pwm_channel - 1, 0); // Initial period is 0; output will be low until first duty cycle is DMA'd in
+
+    chain->initialized = true;
 }
 
-void ws2812_write_led(uint16_t led_number, uint8_t r, uint8_t g, uint8_t b) {
-    // Write color to frame buffer
-    for (uint8_t bit = 0; bit < 8; bit++) {
-        ws2812_frame_buffer[WS2812_RED_BIT(led_number, bit)]   = ((r >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
-        ws2812_frame_buffer[WS2812_GREEN_BIT(led_number, bit)] = ((g >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
-        ws2812_frame_buffer[WS2812_BLUE_BIT(led_number, bit)]  = ((b >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
-    }
+void ws2812_init(void) {
+    ws2812_chain_init(&ws2812_default_chain);
 }
-void ws2812_write_led_rgbw(uint16_t led_number, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+
+static void ws2812_chain_write_led(ws2812_chain_t *chain, uint16_t led_number, LED_TYPE color) {
     // Write color to frame buffer
     for (uint8_t bit = 0; bit < 8; bit++) {
-        ws2812_frame_buffer[WS2812_RED_BIT(led_number, bit)]   = ((r >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
-        ws2812_frame_buffer[WS2812_GREEN_BIT(led_number, bit)] = ((g >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
-        ws2812_frame_buffer[WS2812_BLUE_BIT(led_number, bit)]  = ((b >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
+        chain->buffer[WS2812_RED_BIT(led_number, bit)]   = ((color.r >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
+        chain->buffer[WS2812_GREEN_BIT(led_number, bit)] = ((color.g >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
+        chain->buffer[WS2812_BLUE_BIT(led_number, bit)]  = ((color.b >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
 #ifdef RGBW
-        ws2812_frame_buffer[WS2812_WHITE_BIT(led_number, bit)] = ((w >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
+        chain->buffer[WS2812_WHITE_BIT(led_number, bit)] = ((color.w >> bit) & 0x01) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
 #endif
     }
 }
 
-// Setleds for standard RGB
-void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
-    static bool s_init = false;
-    if (!s_init) {
-        ws2812_init();
-        s_init = true;
+static void ws2812_chain_write(ws2812_chain_t *chain, LED_TYPE *ledarray, uint16_t leds) {
+    if (!chain->initialized) {
+        ws2812_chain_init(chain);
     }
 
-    for (uint16_t i = 0; i < leds; i++) {
+    // The circular DMA stream picks the new frame up on its next pass
+    for (uint16_t i = 0; i < leds && i < chain->led_count; i++) {
+        ws2812_chain_write_led(chain, i, ledarray[i]);
+    }
+}
+
+void ws2812_write_led(uint16_t led_number, uint8_t r, uint8_t g, uint8_t b) {
+    ws2812_chain_write_led(&ws2812_default_chain, led_number, (LED_TYPE){.r = r, .g = g, .b = b});
+}
+void ws2812_write_led_rgbw(uint16_t led_number, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
 #ifdef RGBW
-        ws2812_write_led_rgbw(i, ledarray[i].r, ledarray[i].g, ledarray[i].b, ledarray[i].w);
+    ws2812_chain_write_led(&ws2812_default_chain, led_number, (LED_TYPE){.r = r, .g = g, .b = b, .w = w});
 #else
-        ws2812_write_led(i, ledarray[i].r, ledarray[i].g, ledarray[i].b);
+    ws2812_chain_write_led(&ws2812_default_chain, led_number, (LED_TYPE){.r = r, .g = g, .b = b});
 #endif
+}
+
+bool ws2812_chain_flush(ws2812_chain_t *chain) {
+    if (!chain->dirty) {
+        return true;
     }
+
+    ws2812_chain_write(chain, chain->leds, chain->led_count);
+    chain->dirty = false;
+    return true;
 }
+
+// Setleds for standard RGB
+void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
+    ws2812_chain_write(&ws2812_default_chain, ledarray, leds);
+}
+
+#endif
@@ -1,4 +1,6 @@
+#include <string.h>
 #include "ws2812.h"
+#include "ws2812_chain.h"
 #include "gpio.h"
 #include "util.h"
 #include "chibios_config.h"
@@ -26,15 +28,15 @@
 // Default Push Pull
 #ifndef WS2812_EXTERNAL_PULLUP
 #    if defined(USE_GPIOV1)
-#        define WS2812_MOSI_OUTPUT_MODE PAL_MODE_ALTERNATE_PUSHPULL
+#        define WS2812_MOSI_OUTPUT_MODE(pal_mode) PAL_MODE_ALTERNATE_PUSHPULL
 #    else
-#        define WS2812_MOSI_OUTPUT_MODE PAL_MODE_ALTERNATE(WS2812_SPI_MOSI_PAL_MODE) | PAL_OUTPUT_TYPE_PUSHPULL
+#        define WS2812_MOSI_OUTPUT_MODE(pal_mode) PAL_MODE_ALTERNATE(pal_mode) | PAL_OUTPUT_TYPE_PUSHPULL
 #    endif
 #else
 #    if defined(USE_GPIOV1)
-#        define WS2812_MOSI_OUTPUT_MODE PAL_MODE_ALTERNATE_OPENDRAIN
+#        define WS2812_MOSI_OUTPUT_MODE(pal_mode) PAL_MODE_ALTERNATE_OPENDRAIN
 #    else
-#        define WS2812_MOSI_OUTPUT_MODE PAL_MODE_ALTERNATE(WS2812_SPI_MOSI_PAL_MODE) | PAL_OUTPUT_TYPE_OPENDRAIN
+#        define WS2812_MOSI_OUTPUT_MODE(pal_mode) PAL_MODE_ALTERNATE(pal_mode) | PAL_OUTPUT_TYPE_OPENDRAIN
 #    endif
 #endif
 
@@ -70,9 +72,9 @@
 #endif
 
 #if defined(USE_GPIOV1)
-#    define WS2812_SCK_OUTPUT_MODE PAL_MODE_ALTERNATE_PUSHPULL
+#    define WS2812_SCK_OUTPUT_MODE(pal_mode) PAL_MODE_ALTERNATE_PUSHPULL
 #else
-#    define WS2812_SCK_OUTPUT_MODE PAL_MODE_ALTERNATE(WS2812_SPI_SCK_PAL_MODE) | PAL_OUTPUT_TYPE_PUSHPULL
+#    define WS2812_SCK_OUTPUT_MODE(pal_mode) PAL_MODE_ALTERNATE(pal_mode) | PAL_OUTPUT_TYPE_PUSHPULL
 #endif
 
 #define BYTES_FOR_LED_BYTE 4
@@ -82,11 +84,26 @@
 #    define WS2812_CHANNELS 3
 #endif
 #define BYTES_FOR_LED (BYTES_FOR_LED_BYTE * WS2812_CHANNELS)
-#define DATA_SIZE (BYTES_FOR_LED * WS2812_LED_COUNT)
+#define DATA_SIZE(leds) (BYTES_FOR_LED * (leds))
 #define RESET_SIZE (1000 * WS2812_TRST_US / (2 * WS2812_TIMING))
 #define PREAMBLE_SIZE 4
+#define TXBUF_SIZE(leds) (PREAMBLE_SIZE + DATA_SIZE(leds) + RESET_SIZE)
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+static uint8_t txbuf[TXBUF_SIZE(WS2812_LED_COUNT)] = {0};
+
+static ws2812_chain_t ws2812_default_chain = {
+    .pin        = WS2812_DI_PIN,
+    .led_count  = WS2812_LED_COUNT,
+    .spi_driver = &WS2812_SPI,
+    .pal_mode   = WS2812_SPI_MOSI_PAL_MODE,
+#ifdef WS2812_SPI_SCK_PIN
+    .sck_pin = WS2812_SPI_SCK_PIN,
+#else
+    .sck_pin = NO_PIN,
+#endif
+    .sck_pal_mode = WS2812_SPI_SCK_PAL_MODE,
+    .buffer       = txbuf,
+};
 
 /*
  * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
@@ -106,8 +123,8 @@ static uint8_t get_protocol_eq(uint8_t data, int pos) {
     return eq;
 }
 
-static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
+static void set_led_color_rgb(ws2812_chain_t* chain, LED_TYPE color, int pos) {
+    uint8_t* tx_start = &chain->buffer[PREAMBLE_SIZE];
 
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
     for (int j = 0; j < 4; j++)
@@ -137,23 +154,25 @@ static void set_led_color_rgb(LED_TYPE color, int pos) {
 #endif
 }
 
-void ws2812_init(void) {
-    palSetLineMode(WS2812_DI_PIN, WS2812_MOSI_OUTPUT_MODE);
+void ws2812_chain_init(ws2812_chain_t* chain) {
+    palSetLineMode(chain->pin, WS2812_MOSI_OUTPUT_MODE(chain->pal_mode));
 
-#ifdef WS2812_SPI_SCK_PIN
-    palSetLineMode(WS2812_SPI_SCK_PIN, WS2812_SCK_OUTPUT_MODE);
-#endif // WS2812_SPI_SCK_PIN
+    if (chain->sck_pin != NO_PIN) {
+        palSetLineMode(chain->sck_pin, WS2812_SCK_OUTPUT_MODE(chain->sck_pal_mode));
+    }
+
+    memset(chain->buffer, 0, TXBUF_SIZE(chain->led_count));
 
     // TODO: more dynamic baudrate
-    static const SPIConfig spicfg = {
+    chain->spi_config = (SPIConfig){
 #ifndef HAL_LLD_SELECT_SPI_V2
 // HAL_SPI_V1
 #    if SPI_SUPPORTS_CIRCULAR == TRUE
         WS2812_SPI_BUFFER_MODE,
 #    endif
         NULL, // end_cb
-        PAL_PORT(WS2812_DI_PIN),
-        PAL_PAD(WS2812_DI_PIN),
+        PAL_PORT(chain->pin),
+        PAL_PAD(chain->pin),
 #    if defined(WB32F3G71xx) || defined(WB32FQ95xx)
         0,
         0,
@@ -172,39 +191,69 @@ void ws2812_init(void) {
 #    endif
         NULL, // data_cb
         NULL, // error_cb
-        PAL_PORT(WS2812_DI_PIN),
-        PAL_PAD(WS2812_DI_PIN),
+        PAL_PORT(chain->pin),
+        PAL_PAD(chain->pin),
         WS2812_SPI_DIVISOR_CR1_BR_X,
         0
 #endif
     };
 
-    spiAcquireBus(&WS2812_SPI);     /* Acquire ownership of the bus.    */
-    spiStart(&WS2812_SPI, &spicfg); /* Setup transfer parameters.       */
-    spiSelect(&WS2812_SPI);         /* Slave Select assertion.          */
+    spiAcquireBus(chain->spi_driver);                /* Acquire ownership of the bus.    */
+    spiStart(chain->spi_driver, &chain->spi_config); /* Setup transfer parameters.       */
+    spiSelect(chain->spi_driver);                    /* Slave Select assertion.          */
 #ifdef WS2812_SPI_USE_CIRCULAR_BUFFER
-    spiStartSend(&WS2812_SPI, ARRAY_SIZE(txbuf), txbuf);
+    spiStartSend(chain->spi_driver, TXBUF_SIZE(chain->led_count), chain->buffer);
 #endif
+
+    chain->initialized = true;
 }
 
-void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
-    static bool s_init = false;
-    if (!s_init) {
-        ws2812_init();
-        s_init = true;
+void ws2812_init(void) {
+    ws2812_chain_init(&ws2812_default_chain);
+}
+
+static bool ws2812_chain_busy(ws2812_chain_t* chain) {
+#if !defined(WS2812_SPI_USE_CIRCULAR_BUFFER) && !defined(WS2812_SPI_SYNC)
+    return chain->initialized && chain->spi_driver->state == SPI_ACTIVE;
+#else
+    return false;
+#endif
+}
+
+static void ws2812_chain_write(ws2812_chain_t* chain, LED_TYPE* ledarray, uint16_t leds) {
+    if (!chain->initialized) {
+        ws2812_chain_init(chain);
     }
 
-    for (uint8_t i = 0; i < leds; i++) {
-        set_led_color_rgb(ledarray[i], i);
+    for (uint16_t i = 0; i < leds && i < chain->led_count; i++) {
+        set_led_color_rgb(chain, ledarray[i], i);
     }
 
     // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
     // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
 #ifndef WS2812_SPI_USE_CIRCULAR_BUFFER
 #    ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, ARRAY_SIZE(txbuf), txbuf);
+    spiSend(chain->spi_driver, TXBUF_SIZE(chain->led_count), chain->buffer);
 #    else
-    spiStartSend(&WS2812_SPI, ARRAY_SIZE(txbuf), txbuf);
+    spiStartSend(chain->spi_driver, TXBUF_SIZE(chain->led_count), chain->buffer);
 #    endif
 #endif
 }
+
+bool ws2812_chain_flush(ws2812_chain_t* chain) {
+    if (!chain->dirty) {
+        return true;
+    }
+    // Rewriting the buffer under a running transfer would tear the frame, try again on the next flush
+    if (ws2812_chain_busy(chain)) {
+        return false;
+    }
+
+    ws2812_chain_write(chain, chain->leds, chain->led_count);
+    chain->dirty = false;
+    return true;
+}
+
+void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
+    ws2812_chain_write(&ws2812_default_chain, ledarray, leds);
+}
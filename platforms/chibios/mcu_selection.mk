@@ -253,6 +253,16 @@ ifneq ($(findstring STM32F072, $(MCU)),)
 
   # Bootloader address for STM32 DFU
   STM32_BOOTLOADER_ADDRESS ?= 0x1FFFC800
+
+  # Timer channels for WS2812_DRIVER = auto, in order of preference
+  #   <pin>:<timer>:<channel, N for complementary>:<alternate function>:<DMA stream for TIMx_UP>:<DMA channel>
+  WS2812_PWM_CANDIDATES ?= \
+    A0:2:1:2:1_2:2 A1:2:2:2:1_2:2 A2:2:3:2:1_2:2 A3:2:4:2:1_2:2 A5:2:1:2:1_2:2 A15:2:1:2:1_2:2 \
+    B3:2:2:2:1_2:2 B10:2:3:2:1_2:2 B11:2:4:2:1_2:2 \
+    A6:3:1:1:1_3:3 A7:3:2:1:1_3:3 B0:3:3:1:1_3:3 B1:3:4:1:1_3:3 B4:3:1:1:1_3:3 B5:3:2:1:1_3:3 \
+    C6:3:1:0:1_3:3 C7:3:2:0:1_3:3 C8:3:3:0:1_3:3 C9:3:4:0:1_3:3 \
+    A8:1:1:2:1_5:5 A9:1:2:2:1_5:5 A10:1:3:2:1_5:5 A11:1:4:2:1_5:5 \
+    A7:1:1N:2:1_5:5 B13:1:1N:2:1_5:5 B0:1:2N:2:1_5:5 B14:1:2N:2:1_5:5 B1:1:3N:2:1_5:5 B15:1:3N:2:1_5:5
 endif
 
 ifneq ($(findstring STM32F103, $(MCU)),)
@@ -361,6 +371,18 @@ ifneq ($(findstring STM32F401, $(MCU)),)
 
   # Bootloader address for STM32 DFU
   STM32_BOOTLOADER_ADDRESS ?= 0x1FFF0000
+
+  # Timer channels for WS2812_DRIVER = auto, in order of preference
+  #   <pin>:<timer>:<channel, N for complementary>:<alternate function>:<DMA stream for TIMx_UP>:<DMA channel>
+  WS2812_PWM_CANDIDATES ?= \
+    A0:2:1:1:1_1:3 A1:2:2:1:1_1:3 A2:2:3:1:1_1:3 A3:2:4:1:1_1:3 A5:2:1:1:1_1:3 A15:2:1:1:1_1:3 \
+    B3:2:2:1:1_1:3 B10:2:3:1:1_1:3 \
+    A0:5:1:2:1_0:6 A1:5:2:2:1_0:6 A2:5:3:2:1_0:6 A3:5:4:2:1_0:6 \
+    A6:3:1:2:1_2:5 A7:3:2:2:1_2:5 B0:3:3:2:1_2:5 B1:3:4:2:1_2:5 B4:3:1:2:1_2:5 B5:3:2:2:1_2:5 \
+    C6:3:1:2:1_2:5 C7:3:2:2:1_2:5 C8:3:3:2:1_2:5 C9:3:4:2:1_2:5 \
+    B6:4:1:2:1_6:2 B7:4:2:2:1_6:2 B8:4:3:2:1_6:2 B9:4:4:2:1_6:2 \
+    A8:1:1:1:2_5:6 A9:1:2:1:2_5:6 A10:1:3:1:2_5:6 A11:1:4:1:2_5:6 \
+    A7:1:1N:1:2_5:6 B13:1:1N:1:2_5:6 B0:1:2N:1:2_5:6 B14:1:2N:1:2_5:6 B1:1:3N:1:2_5:6 B15:1:3N:1:2_5:6
 endif
 
 ifneq ($(findstring STM32F405, $(MCU)),)
@@ -472,6 +494,18 @@ ifneq ($(findstring STM32F411, $(MCU)),)
 
   # Bootloader address for STM32 DFU
   STM32_BOOTLOADER_ADDRESS ?= 0x1FFF0000
+
+  # Timer channels for WS2812_DRIVER = auto, in order of preference
+  #   <pin>:<timer>:<channel, N for complementary>:<alternate function>:<DMA stream for TIMx_UP>:<DMA channel>
+  WS2812_PWM_CANDIDATES ?= \
+    A0:2:1:1:1_1:3 A1:2:2:1:1_1:3 A2:2:3:1:1_1:3 A3:2:4:1:1_1:3 A5:2:1:1:1_1:3 A15:2:1:1:1_1:3 \
+    B3:2:2:1:1_1:3 B10:2:3:1:1_1:3 \
+    A0:5:1:2:1_0:6 A1:5:2:2:1_0:6 A2:5:3:2:1_0:6 A3:5:4:2:1_0:6 \
+    A6:3:1:2:1_2:5 A7:3:2:2:1_2:5 B0:3:3:2:1_2:5 B1:3:4:2:1_2:5 B4:3:1:2:1_2:5 B5:3:2:2:1_2:5 \
+    C6:3:1:2:1_2:5 C7:3:2:2:1_2:5 C8:3:3:2:1_2:5 C9:3:4:2:1_2:5 \
+    B6:4:1:2:1_6:2 B7:4:2:2:1_6:2 B8:4:3:2:1_6:2 B9:4:4:2:1_6:2 \
+    A8:1:1:1:2_5:6 A9:1:2:1:2_5:6 A10:1:3:1:2_5:6 A11:1:4:1:2_5:6 \
+    A7:1:1N:1:2_5:6 B13:1:1N:1:2_5:6 B0:1:2N:1:2_5:6 B14:1:2N:1:2_5:6 B1:1:3N:1:2_5:6 B15:1:3N:1:2_5:6
 endif
 
 ifneq ($(findstring STM32F446, $(MCU)),)
@@ -44,6 +44,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    include "encoder.h"
 #endif
 
+#ifdef LATENCY_TRACE_ENABLE
+#    include "latency_trace.h"
+#endif
+
 int tp_buttons;
 
 #if defined(RETRO_TAPPING) || defined(RETRO_TAPPING_PER_KEY) || (defined(AUTO_SHIFT_ENABLE) && defined(RETRO_SHIFT))
@@ -271,7 +275,17 @@ void process_record(keyrecord_t *record) {
         return;
     }
 
-    if (!process_record_quantum(record)) {
+#ifdef LATENCY_TRACE_ENABLE
+    latency_trace_mark(record->event, LATENCY_STAGE_TAPPING);
+#endif
+
+    bool continue_processing = process_record_quantum(record);
+
+#ifdef LATENCY_TRACE_ENABLE
+    latency_trace_mark(record->event, LATENCY_STAGE_PROCESS);
+#endif
+
+    if (!continue_processing) {
 #ifndef NO_ACTION_ONESHOT
         if (is_oneshot_layer_active() && record->event.pressed && keymap_config.oneshot_enable) {
             clear_oneshot_layer_state(ONESHOT_OTHER_KEY_PRESSED);
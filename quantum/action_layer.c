@@ -1,11 +1,13 @@
 #include <limits.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "keyboard.h"
 #include "action.h"
 #include "encoder.h"
 #include "util.h"
 #include "action_layer.h"
+#include "matrix.h"
 
 /** \brief Default Layer State
  */
@@ -316,6 +318,53 @@ action_t store_or_get_action(bool pressed, keypos_t key) {
 #endif
 }
 
+#if defined(LAYER_LOOKUP_CACHE_ENABLE) && !defined(NO_ACTION_LAYER)
+/* The layer each matrix position resolved to for resolved_layers, valid where the bit in resolved_valid is set. */
+static layer_state_t resolved_layers = 0;
+static matrix_row_t  resolved_valid[MATRIX_ROWS];
+static uint8_t       resolved_layer[MATRIX_ROWS][MATRIX_COLS];
+
+/** \brief Layer lookup cache invalidate
+ *
+ * Forgets every resolved layer, e.g. after the keymap was rewritten.
+ */
+void layer_lookup_cache_invalidate(void) {
+    memset(resolved_valid, 0, sizeof(resolved_valid));
+}
+
+/** \brief Layer lookup cache invalidate key
+ *
+ * Forgets the resolved layer of one matrix position, e.g. after one of its keycodes changed.
+ */
+void layer_lookup_cache_invalidate_key(uint8_t row, uint8_t col) {
+    if (row < MATRIX_ROWS && col < MATRIX_COLS) {
+        resolved_valid[row] &= ~((matrix_row_t)1 << col);
+    }
+}
+
+/** \brief Layer lookup cache sync
+ *
+ * A key that resolved above every layer that was switched on or off still resolves to the same layer,
+ * only the keys that resolved at or below the highest changed layer have to be looked up again.
+ */
+static void layer_lookup_cache_sync(layer_state_t layers) {
+    layer_state_t changed = layers ^ resolved_layers;
+    if (!changed) {
+        return;
+    }
+    resolved_layers = layers;
+
+    uint8_t highest = get_highest_layer(changed);
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (resolved_layer[row][col] <= highest) {
+                resolved_valid[row] &= ~((matrix_row_t)1 << col);
+            }
+        }
+    }
+}
+#endif
+
 /** \brief Layer switch get layer
  *
  * Gets the layer based on key info
@@ -326,16 +375,38 @@ uint8_t layer_switch_get_layer(keypos_t key) {
     action.code = ACTION_TRANSPARENT;
 
     layer_state_t layers = layer_state | default_layer_state;
+#    ifdef LAYER_LOOKUP_CACHE_ENABLE
+    // Positions outside the matrix (encoders, combos) are not cached
+    bool cacheable = key.row < MATRIX_ROWS && key.col < MATRIX_COLS;
+    if (cacheable) {
+        layer_lookup_cache_sync(layers);
+        if (resolved_valid[key.row] & ((matrix_row_t)1 << key.col)) {
+            return resolved_layer[key.row][key.col];
+        }
+    }
+#    endif
     /* check top layer first */
     for (int8_t i = MAX_LAYER - 1; i >= 0; i--) {
         if (layers & ((layer_state_t)1 << i)) {
             action = action_for_key(i, key);
             if (action.code != ACTION_TRANSPARENT) {
+#    ifdef LAYER_LOOKUP_CACHE_ENABLE
+                if (cacheable) {
+                    resolved_layer[key.row][key.col] = i;
+                    resolved_valid[key.row] |= (matrix_row_t)1 << key.col;
+                }
+#    endif
                 return i;
             }
         }
     }
     /* fall back to layer 0 */
+#    ifdef LAYER_LOOKUP_CACHE_ENABLE
+    if (cacheable) {
+        resolved_layer[key.row][key.col] = 0;
+        resolved_valid[key.row] |= (matrix_row_t)1 << key.col;
+    }
+#    endif
     return 0;
 #else
     return get_highest_layer(default_layer_state);
@@ -133,6 +133,17 @@ void update_tri_layer(uint8_t layer1, uint8_t layer2, uint8_t layer3);
  * @return layer_state_t returns a modified layer bitmask with tri layer modifications applied
  */
 layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_t layer2, uint8_t layer3);
+
+#    ifdef LAYER_LOOKUP_CACHE_ENABLE
+/**
+ * @brief Forgets the layers every key resolved to. Call after the keymap changed in bulk.
+ */
+void layer_lookup_cache_invalidate(void);
+/**
+ * @brief Forgets the layer the key at row and col resolved to. Call after one of its keycodes changed.
+ */
+void layer_lookup_cache_invalidate_key(uint8_t row, uint8_t col);
+#    endif
 #else
 #    define layer_state 0
 
@@ -153,6 +164,9 @@ layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_
 #    define layer_state_set_user(state) (void)state
 #    define update_tri_layer(layer1, layer2, layer3)
 #    define update_tri_layer_state(state, layer1, layer2, layer3) (void)state
+
+#    define layer_lookup_cache_invalidate()
+#    define layer_lookup_cache_invalidate_key(row, col)
 #endif
 
 /* pressed actions cache */
@@ -0,0 +1,143 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "basic_profiling.h"
+#include "print.h"
+
+static basic_profiling_zone_t *zones      = NULL;
+static basic_profiling_zone_t *zones_tail = NULL;
+static uint8_t                 zone_count = 0;
+
+static void zone_clear(basic_profiling_zone_t *zone) {
+    zone->calls   = 0;
+    zone->min     = UINT32_MAX;
+    zone->max     = 0;
+    zone->total   = 0;
+    zone->outside = 0;
+}
+
+static void zone_register(basic_profiling_zone_t *zone) {
+    zone_clear(zone);
+    zone->registered = true;
+    zone->next       = NULL;
+    if (zones_tail) {
+        zones_tail->next = zone;
+    } else {
+        zones = zone;
+    }
+    zones_tail = zone;
+    zone_count++;
+}
+
+static void zone_stats(const basic_profiling_zone_t *zone, basic_profiling_stats_t *stats) {
+    stats->name       = zone->name;
+    stats->calls      = zone->calls;
+    stats->min        = zone->calls ? zone->min : 0;
+    stats->avg        = zone->calls ? zone->total / zone->calls : 0;
+    stats->max        = zone->max;
+    stats->percentage = (zone->total + zone->outside) ? (zone->total * 100) / (zone->total + zone->outside) : 0;
+}
+
+void basic_profiling_init(void) {
+    basic_profiling_timestamp_init();
+}
+
+void basic_profiling_reset(void) {
+    for (basic_profiling_zone_t *zone = zones; zone; zone = zone->next) {
+        zone_clear(zone);
+    }
+}
+
+void basic_profiling_zone_record(basic_profiling_zone_t *zone, basic_profiling_time_t start, basic_profiling_time_t end) {
+    if (!zone->registered) {
+        zone_register(zone);
+    }
+
+    uint32_t elapsed = (basic_profiling_time_t)(end - start);
+    if (zone->calls) {
+        zone->outside += (basic_profiling_time_t)(start - zone->last_end);
+    }
+    zone->last_end = end;
+    zone->total += elapsed;
+    zone->calls++;
+    if (elapsed < zone->min) {
+        zone->min = elapsed;
+    }
+    if (elapsed > zone->max) {
+        zone->max = elapsed;
+    }
+}
+
+uint8_t basic_profiling_zone_count(void) {
+    return zone_count;
+}
+
+bool basic_profiling_get_zone(uint8_t index, basic_profiling_stats_t *stats) {
+    basic_profiling_zone_t *zone = zones;
+    while (zone && index--) {
+        zone = zone->next;
+    }
+    if (!zone) {
+        return false;
+    }
+
+    zone_stats(zone, stats);
+    return true;
+}
+
+void basic_profiling_print_zone(const basic_profiling_zone_t *zone) {
+#ifndef NO_PRINT
+    basic_profiling_stats_t stats;
+    zone_stats(zone, &stats);
+    uprintf("%s -- calls: %lu, min: %lu, avg: %lu, max: %lu, time spent: %u%%\n", stats.name, (unsigned long)stats.calls, (unsigned long)stats.min, (unsigned long)stats.avg, (unsigned long)stats.max, stats.percentage);
+#endif
+}
+
+void basic_profiling_print(void) {
+    for (basic_profiling_zone_t *zone = zones; zone; zone = zone->next) {
+        basic_profiling_print_zone(zone);
+    }
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = (value >> 24) & 0xFF;
+    return p + 4;
+}
+
+void basic_profiling_raw_hid_dump(uint8_t *data, uint8_t length) {
+    uint8_t *end = data + length;
+    uint8_t  index;
+
+    if (length < 7) {
+        return;
+    }
+
+    index = data[1];
+    memset(&data[2], 0, length - 2);
+    data[2] = zone_count;
+
+    if (index == 0xFF) {
+        put_u32(&data[3], BASIC_PROFILING_CLOCK);
+        return;
+    }
+
+    basic_profiling_stats_t stats;
+    if (length < 20 || !basic_profiling_get_zone(index, &stats)) {
+        return;
+    }
+
+    uint8_t *p = &data[3];
+    p          = put_u32(p, stats.calls);
+    p          = put_u32(p, stats.min);
+    p          = put_u32(p, stats.avg);
+    p          = put_u32(p, stats.max);
+    *p++       = stats.percentage;
+    // Leave the name NUL terminated
+    if (stats.name && p < end) {
+        strncpy((char *)p, stats.name, end - p - 1);
+    }
+}
@@ -19,19 +19,205 @@
         PROFILE_CALL_NAMED(1000, "matrix_task", {
             matrix_task();
         });
+
+    With BASIC_PROFILING_ENABLE = yes in rules.mk, every call site becomes a named
+    zone that accumulates min/avg/max timings and call counts, regardless of
+    whether console is enabled. Arbitrary blocks can be profiled as well:
+
+        PROFILE_ZONE_BEGIN(scan);
+        ...
+        PROFILE_ZONE_END(scan);
+
+    The zones can be printed with basic_profiling_print(), or retrieved without
+    any printf overhead through basic_profiling_raw_hid_dump().
+
+    Timings are in units of BASIC_PROFILING_CLOCK, which is the CPU clock when
+    the DWT cycle counter is available (Cortex-M3 and above).
 */
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #if defined(PROTOCOL_LUFA) || defined(PROTOCOL_VUSB)
-#    define TIMESTAMP_GETTER TCNT0
+#    include <avr/io.h>
+#    include <util/atomic.h>
+#    include "timer_avr.h"
+
+typedef uint32_t basic_profiling_time_t;
+#    define BASIC_PROFILING_CLOCK ((uint32_t)(TIMER_RAW_TOP + 1) * 1000)
+
+extern volatile uint32_t timer_count;
+
+static inline void basic_profiling_timestamp_init(void) {}
+
+// Combines the millisecond count with the raw timer0 value
+static inline basic_profiling_time_t basic_profiling_timestamp(void) {
+    uint32_t ms;
+    uint8_t  raw;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        raw = TIMER_RAW;
+        ms  = timer_count;
+#    if defined(TIFR0)
+        // Compare match pending, the counter has wrapped but the interrupt has not run yet
+        if ((TIFR0 & _BV(OCF0A)) && raw < TIMER_RAW_TOP / 2) {
+            ms++;
+        }
+#    endif
+    }
+    return ms * (TIMER_RAW_TOP + 1) + raw;
+}
+
 #elif defined(PROTOCOL_CHIBIOS)
-#    define TIMESTAMP_GETTER chSysGetRealtimeCounterX()
+#    include <ch.h>
+#    include "chibios_config.h"
+
+#    if defined(__CORTEX_M) && (__CORTEX_M >= 3)
+typedef uint32_t basic_profiling_time_t;
+#        define BASIC_PROFILING_CLOCK (CPU_CLOCK)
+
+static inline void basic_profiling_timestamp_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline basic_profiling_time_t basic_profiling_timestamp(void) {
+    return DWT->CYCCNT;
+}
+#    elif PORT_SUPPORTS_RT == TRUE
+// No DWT, e.g. RP2040 which provides a 1MHz realtime counter instead
+typedef rtcnt_t basic_profiling_time_t;
+#        define BASIC_PROFILING_CLOCK (REALTIME_COUNTER_CLOCK)
+
+static inline void basic_profiling_timestamp_init(void) {}
+
+static inline basic_profiling_time_t basic_profiling_timestamp(void) {
+    return chSysGetRealtimeCounterX();
+}
+#    else
+// No cycle counter at all (e.g. Cortex-M0), fall back to the system tick
+typedef systime_t basic_profiling_time_t;
+#        define BASIC_PROFILING_CLOCK (CH_CFG_ST_FREQUENCY)
+
+static inline void basic_profiling_timestamp_init(void) {}
+
+static inline basic_profiling_time_t basic_profiling_timestamp(void) {
+    return chVTGetSystemTimeX();
+}
+#    endif
+
 #elif defined(PROTOCOL_ARM_ATSAM)
-#    error arm_atsam not currently supported
+#    include "samd51j18a.h"
+#    include "tmk_core/protocol/arm_atsam/clks.h"
+
+typedef uint32_t basic_profiling_time_t;
+#    define BASIC_PROFILING_CLOCK ((uint32_t)(PLL_RATIO + 1) * 1000000)
+
+static inline void basic_profiling_timestamp_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline basic_profiling_time_t basic_profiling_timestamp(void) {
+    return DWT->CYCCNT;
+}
+
 #else
-#    error Unknown protocol in use
+// Host builds (e.g. unit tests), driven by platforms/test/timer.c
+#    include "timer.h"
+
+typedef uint32_t basic_profiling_time_t;
+#    define BASIC_PROFILING_CLOCK 1000
+
+static inline void basic_profiling_timestamp_init(void) {}
+
+static inline basic_profiling_time_t basic_profiling_timestamp(void) {
+    return timer_read32();
+}
 #endif
 
-#ifndef CONSOLE_ENABLE
+#define TIMESTAMP_GETTER basic_profiling_timestamp()
+
+#ifdef BASIC_PROFILING_ENABLE
+
+typedef struct basic_profiling_zone_t {
+    const char                    *name;
+    struct basic_profiling_zone_t *next;
+    bool                           registered;
+    uint32_t                       calls;
+    uint32_t                       min;
+    uint32_t                       max;
+    uint64_t                       total;
+    // Time spent between consecutive calls, used for the percentage
+    uint64_t               outside;
+    basic_profiling_time_t last_end;
+} basic_profiling_zone_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    calls;
+    uint32_t    min;
+    uint32_t    avg;
+    uint32_t    max;
+    uint8_t     percentage;
+} basic_profiling_stats_t;
+
+void basic_profiling_init(void);
+void basic_profiling_reset(void);
+void basic_profiling_zone_record(basic_profiling_zone_t *zone, basic_profiling_time_t start, basic_profiling_time_t end);
+
+uint8_t basic_profiling_zone_count(void);
+
+/**
+ * \brief Retrieve the accumulated statistics of a zone, in order of first use.
+ *
+ * \return false if there is no such zone
+ */
+bool basic_profiling_get_zone(uint8_t index, basic_profiling_stats_t *stats);
+
+void basic_profiling_print_zone(const basic_profiling_zone_t *zone);
+void basic_profiling_print(void);
+
+/**
+ * \brief Fill a raw HID packet with the statistics of the zone requested in data[1].
+ *
+ * Requesting zone 0xFF returns the zone count in data[2] and BASIC_PROFILING_CLOCK
+ * in data[3..6]. Otherwise data[1] is the zone index, data[2] the zone count, followed
+ * by calls, min, avg and max as little endian uint32_t, the percentage of time spent
+ * in the zone, and as much of the zone name as fits.
+ */
+void basic_profiling_raw_hid_dump(uint8_t *data, uint8_t length);
+
+#    define PROFILE_ZONE_BEGIN(id)                                       \
+        static basic_profiling_zone_t profile_zone_##id  = {.name = #id}; \
+        basic_profiling_time_t        profile_start_##id = basic_profiling_timestamp()
+
+#    define PROFILE_ZONE_END(id) basic_profiling_zone_record(&profile_zone_##id, profile_start_##id, basic_profiling_timestamp())
+
+#    ifdef CONSOLE_ENABLE
+#        define PROFILE_ZONE_PRINT(count, zone)               \
+            do {                                              \
+                if ((zone)->calls % ((uint32_t)count) == 0) { \
+                    basic_profiling_print_zone(zone);         \
+                }                                             \
+            } while (0)
+#    else
+#        define PROFILE_ZONE_PRINT(count, zone) \
+            do {                                \
+            } while (0)
+#    endif
+
+#    define PROFILE_CALL_NAMED(count, name, call)                                                   \
+        do {                                                                                        \
+            static basic_profiling_zone_t profile_zone  = {(name)};                                 \
+            basic_profiling_time_t        profile_start = basic_profiling_timestamp();              \
+            do {                                                                                    \
+                call;                                                                               \
+            } while (0);                                                                            \
+            basic_profiling_zone_record(&profile_zone, profile_start, basic_profiling_timestamp()); \
+            PROFILE_ZONE_PRINT(count, &profile_zone);                                               \
+        } while (0)
+
+#elif !defined(CONSOLE_ENABLE)
 // Can't do anything if we don't have console output enabled.
 #    define PROFILE_CALL_NAMED(count, name, call) \
         do {                                      \
@@ -39,20 +225,23 @@
 #else
 #    define PROFILE_CALL_NAMED(count, name, call)                                                                         \
         do {                                                                                                              \
-            static uint64_t inner_sum = 0;                                                                                \
-            static uint64_t outer_sum = 0;                                                                                \
-            uint32_t        start_ts;                                                                                     \
-            static uint32_t end_ts;                                                                                       \
-            static uint32_t write_location = 0;                                                                           \
-            start_ts                       = TIMESTAMP_GETTER;                                                            \
+            static uint64_t               inner_sum = 0;                                                                  \
+            static uint64_t               outer_sum = 0;                                                                  \
+            basic_profiling_time_t        start_ts;                                                                       \
+            static basic_profiling_time_t end_ts;                                                                         \
+            static uint32_t               write_location = 0;                                                             \
+            if (write_location == 0) {                                                                                    \
+                basic_profiling_timestamp_init();                                                                         \
+            }                                                                                                             \
+            start_ts = TIMESTAMP_GETTER;                                                                                  \
             if (write_location > 0) {                                                                                     \
-                outer_sum += start_ts - end_ts;                                                                           \
+                outer_sum += (basic_profiling_time_t)(start_ts - end_ts);                                                 \
             }                                                                                                             \
             do {                                                                                                          \
                 call;                                                                                                     \
             } while (0);                                                                                                  \
             end_ts = TIMESTAMP_GETTER;                                                                                    \
-            inner_sum += end_ts - start_ts;                                                                               \
+            inner_sum += (basic_profiling_time_t)(end_ts - start_ts);                                                     \
             ++write_location;                                                                                             \
             if (write_location >= ((uint32_t)count)) {                                                                    \
                 uint32_t inner_avg = inner_sum / (((uint32_t)count) - 1);                                                 \
@@ -64,6 +253,6 @@
             }                                                                                                             \
         } while (0)
 
-#endif // CONSOLE_ENABLE
+#endif
 
 #define PROFILE_CALL(count, call) PROFILE_CALL_NAMED(count, #call, call)
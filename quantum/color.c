@@ -19,82 +19,56 @@
 #include "progmem.h"
 #include "util.h"
 
-RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
-    RGB      rgb;
-    uint8_t  region, remainder, p, q, t;
-    uint16_t h, s, v;
+// Channel each of v, p, q and t ends up in, for each sixth of the hue circle
+enum { HSV_V, HSV_P, HSV_Q, HSV_T };
 
-    if (hsv.s == 0) {
-#ifdef USE_CIE1931_CURVE
-        if (use_cie) {
-            rgb.r = rgb.g = rgb.b = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-        } else {
-            rgb.r = hsv.v;
-            rgb.g = hsv.v;
-            rgb.b = hsv.v;
-        }
-#else
-        rgb.r = hsv.v;
-        rgb.g = hsv.v;
-        rgb.b = hsv.v;
-#endif
+static const uint8_t hue_sector_channels[7][3] = {
+    {HSV_V, HSV_T, HSV_P}, // red to yellow
+    {HSV_Q, HSV_V, HSV_P}, // yellow to green
+    {HSV_P, HSV_V, HSV_T}, // green to cyan
+    {HSV_P, HSV_Q, HSV_V}, // cyan to blue
+    {HSV_T, HSV_P, HSV_V}, // blue to magenta
+    {HSV_V, HSV_P, HSV_Q}, // magenta to red
+    {HSV_V, HSV_T, HSV_P}, // hue 255
+};
+
+/**
+ * \brief Converts a color whose value has already been corrected.
+ */
+static inline RGB hsv_to_rgb_raw(uint8_t h, uint8_t s, uint8_t v) {
+    RGB rgb;
+
+    if (s == 0) {
+        rgb.r = v;
+        rgb.g = v;
+        rgb.b = v;
         return rgb;
     }
 
-    h = hsv.h;
-    s = hsv.s;
-#ifdef USE_CIE1931_CURVE
-    if (use_cie) {
-        v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-    } else {
-        v = hsv.v;
-    }
-#else
-    v = hsv.v;
-#endif
+    // h * 6 / 255 without a division, exact for every hue
+    uint16_t h6        = h * 6;
+    uint8_t  region    = (h6 + (h6 >> 8) + 1) >> 8;
+    uint8_t  remainder = (h * 2 - region * 85) * 3;
 
-    region    = h * 6 / 255;
-    remainder = (h * 2 - region * 85) * 3;
+    uint8_t channels[4];
+    channels[HSV_V] = v;
+    channels[HSV_P] = (v * (255 - s)) >> 8;
+    channels[HSV_Q] = (v * (255 - ((s * remainder) >> 8))) >> 8;
+    channels[HSV_T] = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
 
-    p = (v * (255 - s)) >> 8;
-    q = (v * (255 - ((s * remainder) >> 8))) >> 8;
-    t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+    rgb.r = channels[hue_sector_channels[region][0]];
+    rgb.g = channels[hue_sector_channels[region][1]];
+    rgb.b = channels[hue_sector_channels[region][2]];
+    return rgb;
+}
 
-    switch (region) {
-        case 6:
-        case 0:
-            rgb.r = v;
-            rgb.g = t;
-            rgb.b = p;
-            break;
-        case 1:
-            rgb.r = q;
-            rgb.g = v;
-            rgb.b = p;
-            break;
-        case 2:
-            rgb.r = p;
-            rgb.g = v;
-            rgb.b = t;
-            break;
-        case 3:
-            rgb.r = p;
-            rgb.g = q;
-            rgb.b = v;
-            break;
-        case 4:
-            rgb.r = t;
-            rgb.g = p;
-            rgb.b = v;
-            break;
-        default:
-            rgb.r = v;
-            rgb.g = p;
-            rgb.b = q;
-            break;
+RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
+#ifdef USE_CIE1931_CURVE
+    if (use_cie) {
+        return hsv_to_rgb_raw(hsv.h, hsv.s, pgm_read_byte(&CIE1931_CURVE[hsv.v]));
     }
-
-    return rgb;
+#endif
+    return hsv_to_rgb_raw(hsv.h, hsv.s, hsv.v);
 }
 
 RGB hsv_to_rgb(HSV hsv) {
@@ -109,6 +83,16 @@ RGB hsv_to_rgb_nocie(HSV hsv) {
     return hsv_to_rgb_impl(hsv, false);
 }
 
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+#ifdef USE_CIE1931_CURVE
+        rgb[i] = hsv_to_rgb_raw(hsv[i].h, hsv[i].s, pgm_read_byte(&CIE1931_CURVE[hsv[i].v]));
+#else
+        rgb[i] = hsv_to_rgb_raw(hsv[i].h, hsv[i].s, hsv[i].v);
+#endif
+    }
+}
+
 #ifdef RGBW
 void convert_rgb_to_rgbw(LED_TYPE *led) {
     // Determine lowest value in all three colors, put that into
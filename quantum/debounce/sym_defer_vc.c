@@ -0,0 +1,176 @@
+/*
+Copyright 2017 Alex Ong<the.onga@gmail.com>
+Copyright 2020 Andrei Purdea<andrei@purdea.ro>
+Copyright 2021 Simon Arlott
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Symmetric per-key algorithm using vertical counters, behaves the same as sym_defer_pk.
+Bit i of every key's counter is stored in counters[i][row], so a whole row of counters is
+updated with a handful of bitwise operations regardless of the number of columns.
+When no state changes have occured for DEBOUNCE milliseconds, we push the state.
+*/
+
+#include "debounce.h"
+#include "timer.h"
+#include <string.h>
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+// Maximum debounce: 255ms
+#if DEBOUNCE > UINT8_MAX
+#    undef DEBOUNCE
+#    define DEBOUNCE UINT8_MAX
+#endif
+
+#if DEBOUNCE < 2
+#    define DEBOUNCE_BITS 1
+#elif DEBOUNCE < 4
+#    define DEBOUNCE_BITS 2
+#elif DEBOUNCE < 8
+#    define DEBOUNCE_BITS 3
+#elif DEBOUNCE < 16
+#    define DEBOUNCE_BITS 4
+#elif DEBOUNCE < 32
+#    define DEBOUNCE_BITS 5
+#elif DEBOUNCE < 64
+#    define DEBOUNCE_BITS 6
+#elif DEBOUNCE < 128
+#    define DEBOUNCE_BITS 7
+#else
+#    define DEBOUNCE_BITS 8
+#endif
+
+#if DEBOUNCE > 0
+static matrix_row_t counters[DEBOUNCE_BITS][MATRIX_ROWS];
+static fast_timer_t last_time;
+static bool         counters_need_update;
+
+static bool update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time);
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows);
+
+void debounce_init(uint8_t num_rows) {
+    memset(counters, 0, sizeof(counters));
+    counters_need_update = false;
+}
+
+void debounce_free(void) {
+    memset(counters, 0, sizeof(counters));
+    counters_need_update = false;
+}
+
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    bool updated_last   = false;
+    bool cooked_changed = false;
+
+    if (counters_need_update) {
+        fast_timer_t now          = timer_read_fast();
+        fast_timer_t elapsed_time = TIMER_DIFF_FAST(now, last_time);
+
+        last_time    = now;
+        updated_last = true;
+        if (elapsed_time > UINT8_MAX) {
+            elapsed_time = UINT8_MAX;
+        }
+
+        if (elapsed_time > 0) {
+            cooked_changed = update_debounce_counters_and_transfer_if_expired(raw, cooked, num_rows, elapsed_time);
+        }
+    }
+
+    if (changed) {
+        if (!updated_last) {
+            last_time = timer_read_fast();
+        }
+
+        start_debounce_counters(raw, cooked, num_rows);
+    }
+
+    return cooked_changed;
+}
+
+static bool update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time) {
+    bool cooked_changed  = false;
+    counters_need_update = false;
+
+#    if DEBOUNCE < UINT8_MAX
+    // No counter is ever above DEBOUNCE, this keeps elapsed_time within DEBOUNCE_BITS
+    if (elapsed_time > DEBOUNCE) {
+        elapsed_time = DEBOUNCE;
+    }
+#    endif
+
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t active = 0;
+        for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+            active |= counters[bit][row];
+        }
+        if (!active) {
+            continue;
+        }
+
+        // Subtract elapsed_time from every counter in the row at once
+        matrix_row_t result[DEBOUNCE_BITS];
+        matrix_row_t borrow  = 0;
+        matrix_row_t nonzero = 0;
+        for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+            matrix_row_t counter  = counters[bit][row];
+            matrix_row_t subtract = (elapsed_time & (1 << bit)) ? ~(matrix_row_t)0 : 0;
+
+            result[bit] = counter ^ subtract ^ borrow;
+            borrow      = (~counter & (subtract | borrow)) | (subtract & borrow);
+            nonzero |= result[bit];
+        }
+
+        // Counters less than or equal to the elapsed time underflow or reach zero
+        matrix_row_t expired   = active & (borrow | ~nonzero);
+        matrix_row_t remaining = active & ~expired;
+        for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+            counters[bit][row] = result[bit] & remaining;
+        }
+        if (remaining) {
+            counters_need_update = true;
+        }
+
+        matrix_row_t cooked_next = (cooked[row] & ~expired) | (raw[row] & expired);
+        cooked_changed |= cooked[row] ^ cooked_next;
+        cooked[row] = cooked_next;
+    }
+
+    return cooked_changed;
+}
+
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t delta  = raw[row] ^ cooked[row];
+        matrix_row_t active = 0;
+        for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+            active |= counters[bit][row];
+        }
+
+        // Start counters for keys that changed, stop them for keys that changed back
+        matrix_row_t start = delta & ~active;
+        for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+            counters[bit][row] = (counters[bit][row] & delta) | ((DEBOUNCE & (1 << bit)) ? start : 0);
+        }
+        if (start) {
+            counters_need_update = true;
+        }
+    }
+}
+
+#else
+#    include "none.c"
+#endif
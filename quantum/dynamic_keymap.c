@@ -21,6 +21,7 @@
 #include "progmem.h"
 #include "send_string.h"
 #include "keycodes.h"
+#include "util.h"
 
 #ifdef VIA_ENABLE
 #    include "via.h"
@@ -101,6 +102,87 @@ _Static_assert((DYNAMIC_KEYMAP_EEPROM_MAX_ADDR) - (DYNAMIC_KEYMAP_MACRO_EEPROM_A
 #    define DYNAMIC_KEYMAP_MACRO_DELAY TAP_CODE_DELAY
 #endif
 
+#define DYNAMIC_KEYMAP_LAYER_SIZE (MATRIX_ROWS * MATRIX_COLS * 2)
+#ifdef ENCODER_MAP_ENABLE
+#    define DYNAMIC_KEYMAP_ENCODER_LAYER_SIZE (NUM_ENCODERS * 2 * 2)
+#else
+#    define DYNAMIC_KEYMAP_ENCODER_LAYER_SIZE 0
+#endif
+
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+// RAM budget of the write-through cache, in bytes. Defaults to mirroring
+// everything: all keymap and encoder map layers, and the macro buffer.
+#    ifndef DYNAMIC_KEYMAP_CACHE_SIZE
+#        define DYNAMIC_KEYMAP_CACHE_SIZE (DYNAMIC_KEYMAP_LAYER_COUNT * (DYNAMIC_KEYMAP_LAYER_SIZE + DYNAMIC_KEYMAP_ENCODER_LAYER_SIZE) + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE)
+#    endif
+
+// Layers are cached from layer 0 upwards until the budget is used up,
+// higher layers fall back to reading EEPROM.
+#    ifndef DYNAMIC_KEYMAP_CACHE_LAYER_COUNT
+#        define DYNAMIC_KEYMAP_CACHE_LAYER_COUNT MIN(DYNAMIC_KEYMAP_LAYER_COUNT, (DYNAMIC_KEYMAP_CACHE_SIZE) / (DYNAMIC_KEYMAP_LAYER_SIZE + DYNAMIC_KEYMAP_ENCODER_LAYER_SIZE))
+#    endif
+
+_Static_assert(DYNAMIC_KEYMAP_CACHE_LAYER_COUNT >= 1 && DYNAMIC_KEYMAP_CACHE_LAYER_COUNT <= DYNAMIC_KEYMAP_LAYER_COUNT, "DYNAMIC_KEYMAP_CACHE_SIZE is too small to cache a single layer.");
+
+// The macro buffer is only cached if it fits in what is left of the budget.
+#    define DYNAMIC_KEYMAP_CACHE_MACROS ((DYNAMIC_KEYMAP_CACHE_SIZE) >= DYNAMIC_KEYMAP_CACHE_LAYER_COUNT * (DYNAMIC_KEYMAP_LAYER_SIZE + DYNAMIC_KEYMAP_ENCODER_LAYER_SIZE) + (DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE))
+
+// Same layout as the EEPROM: big endian keycodes, ordered by layer/row/column
+static uint8_t dynamic_keymap_cache[DYNAMIC_KEYMAP_CACHE_LAYER_COUNT][MATRIX_ROWS][MATRIX_COLS][2];
+#    ifdef ENCODER_MAP_ENABLE
+static uint8_t dynamic_keymap_encoder_cache[DYNAMIC_KEYMAP_CACHE_LAYER_COUNT][NUM_ENCODERS][2][2];
+#    endif
+static uint8_t dynamic_keymap_macro_cache[DYNAMIC_KEYMAP_CACHE_MACROS ? DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE : 1];
+
+void dynamic_keymap_cache_init(void) {
+    eeprom_read_block(dynamic_keymap_cache, (void *)DYNAMIC_KEYMAP_EEPROM_ADDR, sizeof(dynamic_keymap_cache));
+#    ifdef ENCODER_MAP_ENABLE
+    eeprom_read_block(dynamic_keymap_encoder_cache, (void *)DYNAMIC_KEYMAP_ENCODER_EEPROM_ADDR, sizeof(dynamic_keymap_encoder_cache));
+#    endif
+    if (DYNAMIC_KEYMAP_CACHE_MACROS) {
+        eeprom_read_block(dynamic_keymap_macro_cache, (void *)DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR, sizeof(dynamic_keymap_macro_cache));
+    }
+}
+#endif // DYNAMIC_KEYMAP_CACHE_ENABLE
+
+// Byte accessors for the keymap region, offset is relative to DYNAMIC_KEYMAP_EEPROM_ADDR
+static inline uint8_t dynamic_keymap_read_byte(uint16_t offset) {
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    if (offset < sizeof(dynamic_keymap_cache)) {
+        return ((uint8_t *)dynamic_keymap_cache)[offset];
+    }
+#endif
+    return eeprom_read_byte((void *)DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
+}
+
+static inline void dynamic_keymap_update_byte(uint16_t offset, uint8_t value) {
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    if (offset < sizeof(dynamic_keymap_cache)) {
+        ((uint8_t *)dynamic_keymap_cache)[offset] = value;
+    }
+#endif
+    eeprom_update_byte((void *)DYNAMIC_KEYMAP_EEPROM_ADDR + offset, value);
+}
+
+// Byte accessors for the macro buffer, offset is relative to DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR
+static inline uint8_t dynamic_keymap_macro_read_byte(uint16_t offset) {
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    if (DYNAMIC_KEYMAP_CACHE_MACROS) {
+        return dynamic_keymap_macro_cache[offset];
+    }
+#endif
+    return eeprom_read_byte((void *)DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
+}
+
+static inline void dynamic_keymap_macro_update_byte(uint16_t offset, uint8_t value) {
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    if (DYNAMIC_KEYMAP_CACHE_MACROS) {
+        dynamic_keymap_macro_cache[offset] = value;
+    }
+#endif
+    eeprom_update_byte((void *)DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset, value);
+}
+
 uint8_t dynamic_keymap_get_layer_count(void) {
     return DYNAMIC_KEYMAP_LAYER_COUNT;
 }
@@ -112,6 +194,12 @@ void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t c
 
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
     if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || row >= MATRIX_ROWS || column >= MATRIX_COLS) return KC_NO;
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    if (layer < DYNAMIC_KEYMAP_CACHE_LAYER_COUNT) {
+        const uint8_t *cached = dynamic_keymap_cache[layer][row][column];
+        return (cached[0] << 8) | cached[1];
+    }
+#endif
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
     uint16_t keycode = eeprom_read_byte(address) << 8;
@@ -122,9 +210,18 @@ uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column)
 void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
     if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || row >= MATRIX_ROWS || column >= MATRIX_COLS) return;
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    if (layer < DYNAMIC_KEYMAP_CACHE_LAYER_COUNT) {
+        dynamic_keymap_cache[layer][row][column][0] = (uint8_t)(keycode >> 8);
+        dynamic_keymap_cache[layer][row][column][1] = (uint8_t)(keycode & 0xFF);
+    }
+#endif
     // Big endian, so we can read/write EEPROM directly from host if we want
     eeprom_update_byte(address, (uint8_t)(keycode >> 8));
     eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+#ifdef LAYER_LOOKUP_CACHE_ENABLE
+    layer_lookup_cache_invalidate_key(row, column);
+#endif
 }
 
 #ifdef ENCODER_MAP_ENABLE
@@ -134,6 +231,12 @@ void *dynamic_keymap_encoder_to_eeprom_address(uint8_t layer, uint8_t encoder_id
 
 uint16_t dynamic_keymap_get_encoder(uint8_t layer, uint8_t encoder_id, bool clockwise) {
     if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || encoder_id >= NUM_ENCODERS) return KC_NO;
+#    ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    if (layer < DYNAMIC_KEYMAP_CACHE_LAYER_COUNT) {
+        const uint8_t *cached = dynamic_keymap_encoder_cache[layer][encoder_id][clockwise ? 0 : 1];
+        return (cached[0] << 8) | cached[1];
+    }
+#    endif
     void *address = dynamic_keymap_encoder_to_eeprom_address(layer, encoder_id);
     // Big endian, so we can read/write EEPROM directly from host if we want
     uint16_t keycode = ((uint16_t)eeprom_read_byte(address + (clockwise ? 0 : 2))) << 8;
@@ -144,6 +247,12 @@ uint16_t dynamic_keymap_get_encoder(uint8_t layer, uint8_t encoder_id, bool cloc
 void dynamic_keymap_set_encoder(uint8_t layer, uint8_t encoder_id, bool clockwise, uint16_t keycode) {
     if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || encoder_id >= NUM_ENCODERS) return;
     void *address = dynamic_keymap_encoder_to_eeprom_address(layer, encoder_id);
+#    ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    if (layer < DYNAMIC_KEYMAP_CACHE_LAYER_COUNT) {
+        dynamic_keymap_encoder_cache[layer][encoder_id][clockwise ? 0 : 1][0] = (uint8_t)(keycode >> 8);
+        dynamic_keymap_encoder_cache[layer][encoder_id][clockwise ? 0 : 1][1] = (uint8_t)(keycode & 0xFF);
+    }
+#    endif
     // Big endian, so we can read/write EEPROM directly from host if we want
     eeprom_update_byte(address + (clockwise ? 0 : 2), (uint8_t)(keycode >> 8));
     eeprom_update_byte(address + (clockwise ? 0 : 2) + 1, (uint8_t)(keycode & 0xFF));
@@ -168,31 +277,30 @@ void dynamic_keymap_reset(void) {
 }
 
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
+    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * DYNAMIC_KEYMAP_LAYER_SIZE;
     uint8_t *target                     = data;
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < dynamic_keymap_eeprom_size) {
-            *target = eeprom_read_byte(source);
+            *target = dynamic_keymap_read_byte(offset + i);
         } else {
             *target = 0x00;
         }
-        source++;
         target++;
     }
 }
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
+    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * DYNAMIC_KEYMAP_LAYER_SIZE;
     uint8_t *source                     = data;
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < dynamic_keymap_eeprom_size) {
-            eeprom_update_byte(target, *source);
+            dynamic_keymap_update_byte(offset + i, *source);
         }
         source++;
-        target++;
     }
+#ifdef LAYER_LOOKUP_CACHE_ENABLE
+    layer_lookup_cache_invalidate();
+#endif
 }
 
 uint16_t keycode_at_keymap_location(uint8_t layer_num, uint8_t row, uint8_t column) {
@@ -220,37 +328,30 @@ uint16_t dynamic_keymap_macro_get_buffer_size(void) {
 }
 
 void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   source = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
     uint8_t *target = data;
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            *target = eeprom_read_byte(source);
+            *target = dynamic_keymap_macro_read_byte(offset + i);
         } else {
             *target = 0x00;
         }
-        source++;
         target++;
     }
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
     uint8_t *source = data;
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            eeprom_update_byte(target, *source);
+            dynamic_keymap_macro_update_byte(offset + i, *source);
         }
         source++;
-        target++;
     }
 }
 
 void dynamic_keymap_macro_reset(void) {
-    void *p   = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (p != end) {
-        eeprom_update_byte(p, 0);
-        ++p;
+    for (uint16_t offset = 0; offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; offset++) {
+        dynamic_keymap_macro_update_byte(offset, 0);
     }
 }
 
@@ -263,22 +364,21 @@ void dynamic_keymap_macro_send(uint8_t id) {
     // If it's not zero, then we are in the middle
     // of buffer writing, possibly an aborted buffer
     // write. So do nothing.
-    void *p = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1);
-    if (eeprom_read_byte(p) != 0) {
+    if (dynamic_keymap_macro_read_byte(DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1) != 0) {
         return;
     }
 
     // Skip N null characters
     // p will then point to the Nth macro
-    p         = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    uint16_t p   = 0;
+    uint16_t end = DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE;
     while (id > 0) {
         // If we are past the end of the buffer, then there is
         // no Nth macro in the buffer.
         if (p == end) {
             return;
         }
-        if (eeprom_read_byte(p) == 0) {
+        if (dynamic_keymap_macro_read_byte(p) == 0) {
             --id;
         }
         ++p;
@@ -289,7 +389,7 @@ void dynamic_keymap_macro_send(uint8_t id) {
     // We already checked there was a null at the end of
     // the buffer, so this cannot go past the end
     while (1) {
-        data[0] = eeprom_read_byte(p++);
+        data[0] = dynamic_keymap_macro_read_byte(p++);
         data[1] = 0;
         // Stop at the null terminator of this macro string
         if (data[0] == 0) {
@@ -297,14 +397,14 @@ void dynamic_keymap_macro_send(uint8_t id) {
         }
         if (data[0] == SS_QMK_PREFIX) {
             // Get the code
-            data[1] = eeprom_read_byte(p++);
+            data[1] = dynamic_keymap_macro_read_byte(p++);
             // Unexpected null, abort.
             if (data[1] == 0) {
                 return;
             }
             if (data[1] == SS_TAP_CODE || data[1] == SS_DOWN_CODE || data[1] == SS_UP_CODE) {
                 // Get the keycode
-                data[2] = eeprom_read_byte(p++);
+                data[2] = dynamic_keymap_macro_read_byte(p++);
                 // Unexpected null, abort.
                 if (data[2] == 0) {
                     return;
@@ -316,7 +416,7 @@ void dynamic_keymap_macro_send(uint8_t id) {
                 // At most this is 4 digits plus '|'
                 uint8_t i = 2;
                 while (1) {
-                    data[i] = eeprom_read_byte(p++);
+                    data[i] = dynamic_keymap_macro_read_byte(p++);
                     // Unexpected null, abort
                     if (data[i] == 0) {
                         return;
@@ -27,6 +27,12 @@ uint16_t dynamic_keymap_get_encoder(uint8_t layer, uint8_t encoder_id, bool cloc
 void     dynamic_keymap_set_encoder(uint8_t layer, uint8_t encoder_id, bool clockwise, uint16_t keycode);
 #endif // ENCODER_MAP_ENABLE
 void dynamic_keymap_reset(void);
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+// (Re)loads the RAM mirror of the keymap, encoder map and macro buffer from EEPROM.
+// All writes through this API are written through to the mirror, so this only
+// needs calling at boot or after the EEPROM was modified behind its back.
+void dynamic_keymap_cache_init(void);
+#endif // DYNAMIC_KEYMAP_CACHE_ENABLE
 // These get/set the keycodes as stored in the EEPROM buffer
 // Data is big-endian 16-bit values (the keycodes)
 // Order is by layer/row/column
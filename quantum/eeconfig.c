@@ -13,6 +13,10 @@
 #    include "haptic.h"
 #endif
 
+#if defined(DYNAMIC_KEYMAP_ENABLE)
+#    include "dynamic_keymap.h"
+#endif
+
 #if defined(VIA_ENABLE)
 bool via_eeprom_is_valid(void);
 void via_eeprom_set_valid(bool valid);
@@ -45,6 +49,12 @@ __attribute__((weak)) void eeconfig_init_kb(void) {
 void eeconfig_init_quantum(void) {
 #if defined(EEPROM_DRIVER)
     eeprom_driver_erase();
+#    if defined(DYNAMIC_KEYMAP_ENABLE) && defined(DYNAMIC_KEYMAP_CACHE_ENABLE)
+    dynamic_keymap_cache_init();
+#    endif
+#    if defined(DYNAMIC_KEYMAP_ENABLE) && defined(LAYER_LOOKUP_CACHE_ENABLE)
+    layer_lookup_cache_invalidate();
+#    endif
 #endif
 
     eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
@@ -109,6 +119,12 @@ void eeconfig_enable(void) {
 void eeconfig_disable(void) {
 #if defined(EEPROM_DRIVER)
     eeprom_driver_erase();
+#    if defined(DYNAMIC_KEYMAP_ENABLE) && defined(DYNAMIC_KEYMAP_CACHE_ENABLE)
+    dynamic_keymap_cache_init();
+#    endif
+#    if defined(DYNAMIC_KEYMAP_ENABLE) && defined(LAYER_LOOKUP_CACHE_ENABLE)
+    layer_lookup_cache_invalidate();
+#    endif
 #endif
     eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER_OFF);
 }
@@ -105,6 +105,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef VIA_ENABLE
 #    include "via.h"
 #endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+#    include "dynamic_keymap.h"
+#endif
 #ifdef DIP_SWITCH_ENABLE
 #    include "dip_switch.h"
 #endif
@@ -138,6 +141,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef WPM_ENABLE
 #    include "wpm.h"
 #endif
+#ifdef LATENCY_TRACE_ENABLE
+#    include "latency_trace.h"
+#endif
+#ifdef BASIC_PROFILING_ENABLE
+#    include "basic_profiling.h"
+#endif
 
 static uint32_t last_input_modification_time = 0;
 uint32_t        last_input_activity_time(void) {
@@ -407,6 +416,12 @@ void quantum_init(void) {
 void keyboard_init(void) {
     timer_init();
     sync_timer_init();
+#ifdef BASIC_PROFILING_ENABLE
+    basic_profiling_init();
+#endif
+#if defined(DYNAMIC_KEYMAP_ENABLE) && defined(DYNAMIC_KEYMAP_CACHE_ENABLE)
+    dynamic_keymap_cache_init();
+#endif
 #ifdef VIA_ENABLE
     via_init();
 #endif
@@ -546,6 +561,9 @@ static bool matrix_task(void) {
                 const bool key_pressed = current_row & col_mask;
 
                 if (process_keypress) {
+#ifdef LATENCY_TRACE_ENABLE
+                    latency_trace_begin(row, col, key_pressed);
+#endif
                     action_exec(MAKE_KEYEVENT(row, col, key_pressed));
                 }
 
@@ -726,5 +744,9 @@ void keyboard_task(void) {
     bluetooth_task();
 #endif
 
+#ifdef LATENCY_TRACE_ENABLE
+    latency_trace_task();
+#endif
+
     led_task();
 }
@@ -90,4 +90,15 @@ __attribute__((weak)) combo_t* combo_get(uint16_t combo_idx) {
     return combo_get_raw(combo_idx);
 }
 
+#    ifndef COMBO_NO_KEYCODE_INDEX
+// Room for COMBO_KEYCODE_INDEX_KEYS keys per combo of the keymap, capped at COMBO_KEYCODE_INDEX_LENGTH
+#        define NUM_COMBO_KEYCODE_INDEX_ENTRIES MAX(1, MIN(COMBO_KEYCODE_INDEX_LENGTH, (sizeof(key_combos) / sizeof(combo_t)) * COMBO_KEYCODE_INDEX_KEYS))
+
+combo_keycode_entry_t combo_keycode_index[NUM_COMBO_KEYCODE_INDEX_ENTRIES];
+
+uint16_t combo_keycode_index_size(void) {
+    return NUM_COMBO_KEYCODE_INDEX_ENTRIES;
+}
+#    endif // COMBO_NO_KEYCODE_INDEX
+
 #endif // defined(COMBO_ENABLE)
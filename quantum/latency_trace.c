@@ -0,0 +1,285 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "latency_trace.h"
+#include "timer.h"
+#include "print.h"
+#include "util.h"
+
+#if defined(PROTOCOL_CHIBIOS)
+#    include <ch.h>
+#    include "chibios_config.h"
+#    if PORT_SUPPORTS_RT == TRUE
+typedef rtcnt_t latency_time_t;
+#        define LATENCY_TRACE_NOW() chSysGetRealtimeCounterX()
+#        define LATENCY_TRACE_CLOCK (REALTIME_COUNTER_CLOCK)
+#    else
+// No cycle counter (e.g. Cortex-M0), fall back to the system tick
+typedef systime_t latency_time_t;
+#        define LATENCY_TRACE_NOW() chVTGetSystemTimeX()
+#        define LATENCY_TRACE_CLOCK (CH_CFG_ST_FREQUENCY)
+#    endif
+#else
+typedef uint32_t latency_time_t;
+#    define LATENCY_TRACE_NOW() timer_read32()
+#    define LATENCY_TRACE_CLOCK 1000
+#endif
+
+#if LATENCY_TRACE_CLOCK >= 1000000
+#    define LATENCY_TRACE_TICKS_TO_US(t) ((uint32_t)(t) / ((LATENCY_TRACE_CLOCK) / 1000000))
+#else
+#    define LATENCY_TRACE_TICKS_TO_US(t) ((uint32_t)(t) * (1000000 / (LATENCY_TRACE_CLOCK)))
+#endif
+
+// Differences larger than this are treated as negative
+#define LATENCY_TIME_HALF ((latency_time_t)(~(latency_time_t)0) >> 1)
+
+// Two buckets per power of two, covering up to 65ms
+#define LATENCY_TRACE_BUCKETS 32
+
+// Set once the keyboard_task iteration that processed the event is over,
+// reports sent later than that were not caused by this event.
+#define LATENCY_TRACE_SEALED (1 << 7)
+
+typedef struct {
+    keypos_t       key;
+    bool           pressed;
+    uint8_t        stages;
+    latency_time_t timestamp[LATENCY_STAGE_COUNT];
+} latency_trace_entry_t;
+
+static latency_trace_entry_t trace_buffer[LATENCY_TRACE_BUFFER_SIZE];
+static uint8_t               trace_head  = 0;
+static uint8_t               trace_count = 0;
+
+static latency_time_t scan_edge[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t   scan_edge_pending[MATRIX_ROWS];
+static matrix_row_t   committed[MATRIX_ROWS];
+
+static uint16_t histogram[LATENCY_STAGE_COUNT][LATENCY_TRACE_BUCKETS];
+static uint16_t histogram_count[LATENCY_STAGE_COUNT];
+static uint32_t histogram_max[LATENCY_STAGE_COUNT];
+
+static volatile latency_time_t usb_in_time;
+static volatile uint8_t        usb_in_seq;
+static uint8_t                 usb_in_seq_seen;
+
+// __builtin_clz() counts the leading zeros of an unsigned int
+_Static_assert(sizeof(unsigned int) == sizeof(uint32_t), "bucket_for() needs a 32 bit unsigned int");
+
+static uint8_t bucket_for(uint32_t us) {
+    if (us < 2) {
+        return us;
+    }
+    uint8_t msb    = 31 - __builtin_clz(us);
+    uint8_t bucket = msb * 2 + ((us >> (msb - 1)) & 1);
+    return MIN(bucket, LATENCY_TRACE_BUCKETS - 1);
+}
+
+static uint32_t bucket_upper_bound(uint8_t bucket) {
+    if (bucket < 2) {
+        return bucket;
+    }
+    return ((uint32_t)(3 + (bucket & 1)) << (bucket / 2 - 1)) - 1;
+}
+
+static inline latency_trace_entry_t *entry_at(uint8_t index) {
+    return &trace_buffer[(trace_head + LATENCY_TRACE_BUFFER_SIZE - 1 - index) % LATENCY_TRACE_BUFFER_SIZE];
+}
+
+static inline latency_time_t entry_origin(const latency_trace_entry_t *entry) {
+    return (entry->stages & (1 << LATENCY_STAGE_SCAN_EDGE)) ? entry->timestamp[LATENCY_STAGE_SCAN_EDGE] : entry->timestamp[LATENCY_STAGE_DEBOUNCE];
+}
+
+static void stamp(latency_trace_entry_t *entry, latency_stage_t stage, latency_time_t now) {
+    entry->timestamp[stage] = now;
+    entry->stages |= (1 << stage);
+
+    // Without a scan edge the debounce stage is the origin, nothing to measure
+    if (stage == LATENCY_STAGE_DEBOUNCE && !(entry->stages & (1 << LATENCY_STAGE_SCAN_EDGE))) {
+        return;
+    }
+
+    uint32_t us = LATENCY_TRACE_TICKS_TO_US((latency_time_t)(now - entry_origin(entry)));
+    if (histogram_count[stage] < UINT16_MAX) {
+        histogram_count[stage]++;
+        histogram[stage][bucket_for(us)]++;
+    }
+    if (us > histogram_max[stage]) {
+        histogram_max[stage] = us;
+    }
+}
+
+void latency_trace_clear(void) {
+    memset(trace_buffer, 0, sizeof(trace_buffer));
+    trace_head  = 0;
+    trace_count = 0;
+    memset(scan_edge_pending, 0, sizeof(scan_edge_pending));
+    memset(histogram, 0, sizeof(histogram));
+    memset(histogram_count, 0, sizeof(histogram_count));
+    memset(histogram_max, 0, sizeof(histogram_max));
+}
+
+void latency_trace_scan(uint8_t row_offset, const matrix_row_t previous[], const matrix_row_t current[], uint8_t num_rows) {
+    latency_time_t now = LATENCY_TRACE_NOW();
+    for (uint8_t i = 0; i < num_rows; i++) {
+        uint8_t      row     = row_offset + i;
+        matrix_row_t changes = previous[i] ^ current[i];
+        if (!changes) {
+            continue;
+        }
+
+        // Keys bouncing back to their committed state are no longer pending
+        scan_edge_pending[row] &= ~(changes & ~(current[i] ^ committed[row]));
+
+        matrix_row_t new_edges = changes & (current[i] ^ committed[row]) & ~scan_edge_pending[row];
+        scan_edge_pending[row] |= new_edges;
+        for (uint8_t col = 0; new_edges; col++, new_edges >>= 1) {
+            if (new_edges & 1) {
+                scan_edge[row][col] = now;
+            }
+        }
+    }
+}
+
+void latency_trace_begin(uint8_t row, uint8_t col, bool pressed) {
+    latency_time_t         now   = LATENCY_TRACE_NOW();
+    latency_trace_entry_t *entry = &trace_buffer[trace_head];
+    matrix_row_t           mask  = (matrix_row_t)1 << col;
+
+    trace_head = (trace_head + 1) % LATENCY_TRACE_BUFFER_SIZE;
+    if (trace_count < LATENCY_TRACE_BUFFER_SIZE) {
+        trace_count++;
+    }
+
+    entry->key     = (keypos_t){.row = row, .col = col};
+    entry->pressed = pressed;
+    entry->stages  = 0;
+
+    if (scan_edge_pending[row] & mask) {
+        entry->timestamp[LATENCY_STAGE_SCAN_EDGE] = scan_edge[row][col];
+        entry->stages |= (1 << LATENCY_STAGE_SCAN_EDGE);
+        scan_edge_pending[row] &= ~mask;
+    }
+    if (pressed) {
+        committed[row] |= mask;
+    } else {
+        committed[row] &= ~mask;
+    }
+
+    stamp(entry, LATENCY_STAGE_DEBOUNCE, now);
+}
+
+void latency_trace_mark(keyevent_t event, latency_stage_t stage) {
+    if (!IS_KEYEVENT(event)) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < trace_count; i++) {
+        latency_trace_entry_t *entry = entry_at(i);
+        if (KEYEQ(entry->key, event.key) && entry->pressed == event.pressed) {
+            // Only the first pass through a stage is of interest
+            if (!(entry->stages & (1 << stage))) {
+                stamp(entry, stage, LATENCY_TRACE_NOW());
+            }
+            return;
+        }
+    }
+}
+
+void latency_trace_report(void) {
+    latency_time_t now = LATENCY_TRACE_NOW();
+    for (uint8_t i = 0; i < trace_count; i++) {
+        latency_trace_entry_t *entry = entry_at(i);
+        if ((entry->stages & ((1 << LATENCY_STAGE_PROCESS) | (1 << LATENCY_STAGE_REPORT) | LATENCY_TRACE_SEALED)) == (1 << LATENCY_STAGE_PROCESS)) {
+            stamp(entry, LATENCY_STAGE_REPORT, now);
+        }
+    }
+}
+
+void latency_trace_usb_in_isr(void) {
+    usb_in_time = LATENCY_TRACE_NOW();
+    usb_in_seq++;
+}
+
+void latency_trace_task(void) {
+    if (usb_in_seq != usb_in_seq_seen) {
+        usb_in_seq_seen          = usb_in_seq;
+        latency_time_t completed = usb_in_time;
+        for (uint8_t i = 0; i < trace_count; i++) {
+            latency_trace_entry_t *entry = entry_at(i);
+            if ((entry->stages & ((1 << LATENCY_STAGE_REPORT) | (1 << LATENCY_STAGE_USB_IN))) == (1 << LATENCY_STAGE_REPORT)) {
+                // Skip reports that were queued after this transfer completed
+                if ((latency_time_t)(completed - entry->timestamp[LATENCY_STAGE_REPORT]) <= LATENCY_TIME_HALF) {
+                    stamp(entry, LATENCY_STAGE_USB_IN, completed);
+                }
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < trace_count; i++) {
+        latency_trace_entry_t *entry = entry_at(i);
+        if (entry->stages & (1 << LATENCY_STAGE_PROCESS)) {
+            entry->stages |= LATENCY_TRACE_SEALED;
+        }
+    }
+
+#if LATENCY_TRACE_PRINT_INTERVAL > 0
+    static uint32_t last_print = 0;
+    if (timer_elapsed32(last_print) >= LATENCY_TRACE_PRINT_INTERVAL) {
+        last_print = timer_read32();
+        latency_trace_print();
+    }
+#endif
+}
+
+bool latency_trace_get_record(uint8_t index, latency_trace_record_t *record) {
+    if (index >= trace_count) {
+        return false;
+    }
+
+    const latency_trace_entry_t *entry  = entry_at(index);
+    latency_time_t               origin = entry_origin(entry);
+
+    record->key     = entry->key;
+    record->pressed = entry->pressed;
+    record->stages  = entry->stages & ~LATENCY_TRACE_SEALED;
+    for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        record->offset_us[stage] = (entry->stages & (1 << stage)) ? LATENCY_TRACE_TICKS_TO_US((latency_time_t)(entry->timestamp[stage] - origin)) : 0;
+    }
+    return true;
+}
+
+static uint32_t percentile(latency_stage_t stage, uint8_t percent) {
+    uint32_t target     = ((uint32_t)histogram_count[stage] * percent + 99) / 100;
+    uint32_t cumulative = 0;
+    for (uint8_t bucket = 0; bucket < LATENCY_TRACE_BUCKETS; bucket++) {
+        cumulative += histogram[stage][bucket];
+        if (cumulative >= target) {
+            return MIN(bucket_upper_bound(bucket), histogram_max[stage]);
+        }
+    }
+    return histogram_max[stage];
+}
+
+void latency_trace_get_stats(latency_stage_t stage, latency_trace_stats_t *stats) {
+    stats->count  = histogram_count[stage];
+    stats->p50_us = stats->count ? percentile(stage, 50) : 0;
+    stats->p99_us = stats->count ? percentile(stage, 99) : 0;
+    stats->max_us = histogram_max[stage];
+}
+
+void latency_trace_print(void) {
+#ifndef NO_PRINT
+    static const char *const stage_names[LATENCY_STAGE_COUNT] = {"scan", "debounce", "tapping", "process", "report", "usb_in"};
+
+    for (uint8_t stage = LATENCY_STAGE_DEBOUNCE; stage < LATENCY_STAGE_COUNT; stage++) {
+        latency_trace_stats_t stats;
+        latency_trace_get_stats(stage, &stats);
+        if (stats.count) {
+            uprintf("latency %-8s n=%u p50=%luus p99=%luus max=%luus\n", stage_names[stage], stats.count, (unsigned long)stats.p50_us, (unsigned long)stats.p99_us, (unsigned long)stats.max_us);
+        }
+    }
+#endif
+}
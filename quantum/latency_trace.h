@@ -0,0 +1,76 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+#include "matrix.h"
+
+/*
+    Records when each key event reaches each stage of the input pipeline, from
+    the raw matrix edge through to the USB IN transfer of the resulting report.
+
+    The most recent events are kept in a ring buffer, and every stage also feeds
+    a histogram of its latency relative to the scan edge, from which p50/p99/max
+    are derived. Both can be dumped to the console with latency_trace_print(), or
+    exported over raw HID with latency_trace_get_record()/latency_trace_get_stats().
+*/
+
+#ifndef LATENCY_TRACE_BUFFER_SIZE
+#    define LATENCY_TRACE_BUFFER_SIZE 16
+#endif
+
+// Interval in milliseconds for automatically printing the statistics, 0 disables
+#ifndef LATENCY_TRACE_PRINT_INTERVAL
+#    define LATENCY_TRACE_PRINT_INTERVAL 0
+#endif
+
+typedef enum {
+    LATENCY_STAGE_SCAN_EDGE,     // raw matrix changed
+    LATENCY_STAGE_DEBOUNCE,      // debounced matrix changed
+    LATENCY_STAGE_TAPPING,       // released by the tapping state machine
+    LATENCY_STAGE_PROCESS,       // process_record_quantum() returned
+    LATENCY_STAGE_REPORT,        // report handed to the host driver
+    LATENCY_STAGE_USB_IN,        // host collected the report
+    LATENCY_STAGE_COUNT,
+} latency_stage_t;
+
+typedef struct {
+    keypos_t key;
+    bool     pressed;
+    uint8_t  stages; // bitmask of recorded stages
+    // Microseconds since the earliest recorded stage
+    uint32_t offset_us[LATENCY_STAGE_COUNT];
+} latency_trace_record_t;
+
+typedef struct {
+    uint16_t count;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} latency_trace_stats_t;
+
+void latency_trace_clear(void);
+void latency_trace_task(void);
+void latency_trace_print(void);
+
+// Pipeline hooks
+void latency_trace_scan(uint8_t row_offset, const matrix_row_t previous[], const matrix_row_t current[], uint8_t num_rows);
+void latency_trace_begin(uint8_t row, uint8_t col, bool pressed);
+void latency_trace_mark(keyevent_t event, latency_stage_t stage);
+void latency_trace_report(void);
+void latency_trace_usb_in_isr(void);
+
+/**
+ * \brief Retrieve a recorded event, 0 being the most recent.
+ *
+ * \return false if there is no such record
+ */
+bool latency_trace_get_record(uint8_t index, latency_trace_record_t *record);
+
+/**
+ * \brief Retrieve the latency statistics of a stage, measured from the scan edge.
+ */
+void latency_trace_get_stats(latency_stage_t stage, latency_trace_stats_t *stats);
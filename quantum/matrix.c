@@ -21,6 +21,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "matrix.h"
 #include "debounce.h"
 #include "atomic_util.h"
+#ifdef LATENCY_TRACE_ENABLE
+#    include "latency_trace.h"
+#endif
 
 #ifdef SPLIT_KEYBOARD
 #    include "split_common/split_util.h"
@@ -51,6 +54,34 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    define MATRIX_INPUT_PRESSED_STATE 0
 #endif
 
+#ifdef MATRIX_PORT_SCAN
+#    if defined(DIRECT_PINS) || (DIODE_DIRECTION != COL2ROW)
+#        error "MATRIX_PORT_SCAN is only supported for COL2ROW matrices"
+#    elif !defined(readPort)
+#        error "MATRIX_PORT_SCAN is not supported on this platform"
+#    endif
+#endif
+
+#ifdef MATRIX_IDLE_WAIT
+#    if !defined(PROTOCOL_CHIBIOS)
+#        error "MATRIX_IDLE_WAIT is only supported on ChibiOS"
+#    elif PAL_USE_CALLBACKS != TRUE
+#        error "MATRIX_IDLE_WAIT requires PAL_USE_CALLBACKS to be enabled in halconf.h"
+#    endif
+#    include <ch.h>
+#    include "timer.h"
+
+// Time in milliseconds without any key activity before arming the edge events
+#    ifndef MATRIX_IDLE_WAIT_DELAY
+#        define MATRIX_IDLE_WAIT_DELAY 10
+#    endif
+// Maximum time in milliseconds to sleep per scan while idle, so that the rest of
+// the main loop (RGB, displays, host communication) keeps running
+#    ifndef MATRIX_IDLE_WAIT_TIMEOUT
+#        define MATRIX_IDLE_WAIT_TIMEOUT 1
+#    endif
+#endif
+
 #ifdef DIRECT_PINS
 static SPLIT_MUTABLE pin_t direct_pins[ROWS_PER_HAND][MATRIX_COLS] = DIRECT_PINS;
 #elif (DIODE_DIRECTION == ROW2COL) || (DIODE_DIRECTION == COL2ROW)
@@ -163,6 +194,78 @@ static void unselect_rows(void) {
     }
 }
 
+#            ifdef MATRIX_PORT_SCAN
+// Columns on consecutive pads of the same port, in the same order, are read as one run
+typedef struct {
+    uint8_t     port;  // index into col_ports
+    uint8_t     pad;   // pad of the first column
+    uint8_t     col;   // first column
+    uint8_t     width; // number of columns
+    port_data_t mask;  // one bit per column, shifted down to bit 0
+} col_run_t;
+
+static port_t    col_ports[MATRIX_COLS];
+static uint8_t   col_port_count = 0;
+static col_run_t col_runs[MATRIX_COLS];
+static uint8_t   col_run_count = 0;
+
+/**
+ * \brief Build the port and run tables from col_pins, so that a row is read with one access per port.
+ */
+static void col_runs_init(void) {
+    col_port_count = 0;
+    col_run_count  = 0;
+
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        pin_t pin = col_pins[col];
+        if (pin == NO_PIN) {
+            continue;
+        }
+
+        port_t  port = getPinPort(pin);
+        uint8_t pad  = getPinPad(pin);
+        uint8_t port_index;
+        for (port_index = 0; port_index < col_port_count; port_index++) {
+            if (col_ports[port_index] == port) {
+                break;
+            }
+        }
+        if (port_index == col_port_count) {
+            col_ports[col_port_count++] = port;
+        }
+
+        if (col_run_count > 0) {
+            col_run_t *run = &col_runs[col_run_count - 1];
+            if (run->port == port_index && run->col + run->width == col && run->pad + run->width == pad) {
+                run->mask |= (port_data_t)1 << run->width;
+                run->width++;
+                continue;
+            }
+        }
+        col_runs[col_run_count++] = (col_run_t){.port = port_index, .pad = pad, .col = col, .width = 1, .mask = 1};
+    }
+}
+
+static matrix_row_t read_cols(void) {
+    port_data_t  port_values[MATRIX_COLS];
+    matrix_row_t current_row_value = 0;
+
+    for (uint8_t i = 0; i < col_port_count; i++) {
+        port_values[i] = readPort(col_ports[i]);
+#                if MATRIX_INPUT_PRESSED_STATE == 0
+        port_values[i] = ~port_values[i];
+#                endif
+    }
+
+    for (uint8_t i = 0; i < col_run_count; i++) {
+        const col_run_t *run = &col_runs[i];
+        current_row_value |= (matrix_row_t)((port_values[run->port] >> run->pad) & run->mask) << run->col;
+    }
+
+    return current_row_value;
+}
+#            endif
+
 __attribute__((weak)) void matrix_init_pins(void) {
     unselect_rows();
     for (uint8_t x = 0; x < MATRIX_COLS; x++) {
@@ -170,6 +273,9 @@ __attribute__((weak)) void matrix_init_pins(void) {
             setPinInputHigh_atomic(col_pins[x]);
         }
     }
+#            ifdef MATRIX_PORT_SCAN
+    col_runs_init();
+#            endif
 }
 
 __attribute__((weak)) void matrix_read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
@@ -181,6 +287,9 @@ __attribute__((weak)) void matrix_read_cols_on_row(matrix_row_t current_matrix[]
     }
     matrix_output_select_delay();
 
+#            ifdef MATRIX_PORT_SCAN
+    current_row_value = read_cols();
+#            else
     // For each col...
     matrix_row_t row_shifter = MATRIX_ROW_SHIFTER;
     for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++, row_shifter <<= 1) {
@@ -189,6 +298,7 @@ __attribute__((weak)) void matrix_read_cols_on_row(matrix_row_t current_matrix[]
         // Populate the matrix row with the state of the col pin
         current_row_value |= pin_state ? 0 : row_shifter;
     }
+#            endif
 
     // Unselect row
     unselect_row(current_row);
@@ -270,6 +380,112 @@ __attribute__((weak)) void matrix_read_rows_on_col(matrix_row_t current_matrix[]
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#ifdef MATRIX_IDLE_WAIT
+static thread_reference_t idle_waiter = NULL;
+static volatile bool      idle_edge   = false;
+static bool               idle_armed  = false;
+static uint16_t           idle_timer  = 0;
+
+static void idle_edge_cb(void *arg) {
+    (void)arg;
+    chSysLockFromISR();
+    idle_edge = true;
+    chThdResumeI(&idle_waiter, MSG_OK);
+    chSysUnlockFromISR();
+}
+
+static bool idle_sense_pin(pin_t pin, bool enable) {
+    if (pin == NO_PIN) {
+        return false;
+    }
+    if (enable) {
+        palSetLineCallback(pin, idle_edge_cb, NULL);
+        palEnableLineEvent(pin, PAL_EVENT_MODE_BOTH_EDGES);
+        return readMatrixPin(pin) == 0;
+    }
+    palDisableLineEvent(pin);
+    return false;
+}
+
+/**
+ * \brief Drive every row (or col) active at once and enable edge events on the inputs.
+ *
+ * \return true if a key is already held down
+ */
+static bool idle_arm(bool enable) {
+    bool pressed = false;
+
+#    if defined(DIRECT_PINS)
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            pressed |= idle_sense_pin(direct_pins[row][col], enable);
+        }
+    }
+#    elif (DIODE_DIRECTION == COL2ROW)
+    if (enable) {
+        for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+            select_row(row);
+        }
+        matrix_output_select_delay();
+    } else {
+        unselect_rows();
+    }
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        pressed |= idle_sense_pin(col_pins[col], enable);
+    }
+#    elif (DIODE_DIRECTION == ROW2COL)
+    if (enable) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            select_col(col);
+        }
+        matrix_output_select_delay();
+    } else {
+        unselect_cols();
+    }
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        pressed |= idle_sense_pin(row_pins[row], enable);
+    }
+#    endif
+
+    return pressed;
+}
+
+/**
+ * \brief Sleep until a pin edge while nothing is pressed.
+ *
+ * \return true if the matrix is idle and does not need to be scanned
+ */
+static bool matrix_idle_wait(void) {
+    if (!idle_armed) {
+        if (timer_elapsed(idle_timer) < MATRIX_IDLE_WAIT_DELAY) {
+            return false;
+        }
+        idle_edge = false;
+        if (idle_arm(true)) {
+            idle_arm(false);
+            idle_timer = timer_read();
+            return false;
+        }
+        idle_armed = true;
+    }
+
+    chSysLock();
+    if (!idle_edge) {
+        chThdSuspendTimeoutS(&idle_waiter, TIME_MS2I(MATRIX_IDLE_WAIT_TIMEOUT));
+    }
+    chSysUnlock();
+
+    if (!idle_edge) {
+        return true;
+    }
+
+    idle_arm(false);
+    idle_armed = false;
+    idle_timer = timer_read();
+    return false;
+}
+#endif
+
 void matrix_init(void) {
 #ifdef SPLIT_KEYBOARD
     // Set pinout for right half if pinout for that half is defined
@@ -323,20 +539,34 @@ __attribute__((weak)) bool transport_master_if_connected(matrix_row_t master_mat
 uint8_t matrix_scan(void) {
     matrix_row_t curr_matrix[MATRIX_ROWS] = {0};
 
+#ifdef MATRIX_IDLE_WAIT
+    // While idle the raw matrix is known to be all clear, same as curr_matrix
+    if (!matrix_idle_wait()) {
+#endif
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
-    // Set row, read cols
-    for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
-        matrix_read_cols_on_row(curr_matrix, current_row);
-    }
+        // Set row, read cols
+        for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
+            matrix_read_cols_on_row(curr_matrix, current_row);
+        }
 #elif (DIODE_DIRECTION == ROW2COL)
-    // Set col, read rows
-    matrix_row_t row_shifter = MATRIX_ROW_SHIFTER;
-    for (uint8_t current_col = 0; current_col < MATRIX_COLS; current_col++, row_shifter <<= 1) {
-        matrix_read_rows_on_col(curr_matrix, current_col, row_shifter);
+        // Set col, read rows
+        matrix_row_t row_shifter = MATRIX_ROW_SHIFTER;
+        for (uint8_t current_col = 0; current_col < MATRIX_COLS; current_col++, row_shifter <<= 1) {
+            matrix_read_rows_on_col(curr_matrix, current_col, row_shifter);
+        }
+#endif
+#ifdef MATRIX_IDLE_WAIT
     }
 #endif
 
     bool changed = memcmp(raw_matrix, curr_matrix, sizeof(curr_matrix)) != 0;
+#ifdef LATENCY_TRACE_ENABLE
+#    ifdef SPLIT_KEYBOARD
+    if (changed) latency_trace_scan(thisHand, raw_matrix, curr_matrix, ROWS_PER_HAND);
+#    else
+    if (changed) latency_trace_scan(0, raw_matrix, curr_matrix, ROWS_PER_HAND);
+#    endif
+#endif
     if (changed) memcpy(raw_matrix, curr_matrix, sizeof(curr_matrix));
 
 #ifdef SPLIT_KEYBOARD
@@ -345,5 +575,19 @@ uint8_t matrix_scan(void) {
     changed = debounce(raw_matrix, matrix, ROWS_PER_HAND, changed);
     matrix_scan_kb();
 #endif
+
+#ifdef MATRIX_IDLE_WAIT
+    // Keep scanning at full rate while any key is held or still debouncing
+    for (uint8_t i = 0; i < ROWS_PER_HAND; i++) {
+#    ifdef SPLIT_KEYBOARD
+        if (raw_matrix[i] || matrix[thisHand + i]) {
+#    else
+        if (raw_matrix[i] || matrix[i]) {
+#    endif
+            idle_timer = timer_read();
+            break;
+        }
+    }
+#endif
     return (uint8_t)changed;
 }
@@ -20,6 +20,9 @@
 #include <string.h>
 #include "timer.h"
 #include "gpio.h"
+#ifdef __AVR__
+#    include "atomic_util.h"
+#endif
 
 #ifdef MOUSEKEY_ENABLE
 #    include "mousekey.h"
@@ -79,6 +82,20 @@ uint16_t pointing_device_get_shared_cpi(void) {
 static report_mouse_t local_mouse_report         = {};
 static bool           pointing_device_force_send = false;
 
+// Motion added by pointing_device_accumulate_motion() and taken into reports by pointing_device_drain_motion().
+// Each total has a single writer, so the sensor side may run in an interrupt without any locking.
+static volatile int32_t motion_added_x = 0;
+static volatile int32_t motion_added_y = 0;
+static int32_t          motion_taken_x = 0;
+static int32_t          motion_taken_y = 0;
+
+#ifdef POINTING_DEVICE_STATS
+static pointing_device_stats_t pointing_device_stats = {};
+static volatile uint32_t       motion_since          = 0; // time of the oldest motion not yet in a report
+static uint32_t                report_since          = 0; // time of the oldest motion in local_mouse_report
+static bool                    report_has_motion     = false;
+#endif
+
 extern const pointing_device_driver_t pointing_device_driver;
 
 /**
@@ -160,6 +177,107 @@ __attribute__((weak)) void pointing_device_init(void) {
     pointing_device_init_user();
 }
 
+/**
+ * @brief Adds sensor motion to the pointing device accumulator
+ *
+ * Motion is kept until pointing_device_drain_motion() moves it into a mouse report, so nothing is lost to
+ * clamping or while the host is busy. May be called from an interrupt, e.g. on the sensor's motion pin, as
+ * long as it is always called from the same context.
+ *
+ * @param[in] x int16_t motion along the x axis
+ * @param[in] y int16_t motion along the y axis
+ */
+void pointing_device_accumulate_motion(int16_t x, int16_t y) {
+#ifdef POINTING_DEVICE_STATS
+    if (motion_added_x == motion_taken_x && motion_added_y == motion_taken_y) {
+        motion_since = timer_read32();
+    }
+    pointing_device_stats.samples++;
+#endif
+    motion_added_x += x;
+    motion_added_y += y;
+}
+
+static inline int32_t motion_read(volatile int32_t *total) {
+#ifdef __AVR__
+    int32_t value;
+    ATOMIC_BLOCK_FORCEON {
+        value = *total;
+    }
+    return value;
+#else
+    // Aligned 32 bit loads are atomic
+    return *total;
+#endif
+}
+
+static inline int32_t motion_take(int32_t report, int32_t pending) {
+    int32_t value = report + pending;
+    if (value < XY_REPORT_MIN) {
+        value = XY_REPORT_MIN;
+    } else if (value > XY_REPORT_MAX) {
+        value = XY_REPORT_MAX;
+    }
+    return value - report;
+}
+
+/**
+ * @brief Moves accumulated motion into a mouse report
+ *
+ * Adds as much of the accumulated motion to the report as fits, the rest is carried over to the next report.
+ *
+ * @param[in] mouse_report report_mouse_t to add the motion to
+ * @return true if any motion was added
+ */
+bool pointing_device_drain_motion(report_mouse_t *mouse_report) {
+    int32_t pending_x = motion_read(&motion_added_x) - motion_taken_x;
+    int32_t pending_y = motion_read(&motion_added_y) - motion_taken_y;
+
+    if (!pending_x && !pending_y) {
+        return false;
+    }
+
+    int32_t x = motion_take(mouse_report->x, pending_x);
+    int32_t y = motion_take(mouse_report->y, pending_y);
+    mouse_report->x += x;
+    mouse_report->y += y;
+    motion_taken_x += x;
+    motion_taken_y += y;
+
+#ifdef POINTING_DEVICE_STATS
+    if (!report_has_motion) {
+        report_since      = motion_since;
+        report_has_motion = true;
+    }
+    if (x != pending_x || y != pending_y) {
+        pointing_device_stats.carried++;
+    }
+#endif
+    return x || y;
+}
+
+#ifdef POINTING_DEVICE_STATS
+/**
+ * @brief Gets the pointing device pipeline counters
+ *
+ * NOTE : Only available when POINTING_DEVICE_STATS is defined
+ *
+ * @return pointing_device_stats_t
+ */
+pointing_device_stats_t pointing_device_get_stats(void) {
+    return pointing_device_stats;
+}
+
+/**
+ * @brief Clears the pointing device pipeline counters
+ *
+ * NOTE : Only available when POINTING_DEVICE_STATS is defined
+ */
+void pointing_device_clear_stats(void) {
+    memset(&pointing_device_stats, 0, sizeof(pointing_device_stats));
+}
+#endif
+
 /**
  * @brief Sends processed mouse report to host
  *
@@ -172,7 +290,20 @@ __attribute__((weak)) bool pointing_device_send(void) {
 
     if (should_send_report) {
         host_mouse_send(&local_mouse_report);
+#ifdef POINTING_DEVICE_STATS
+        pointing_device_stats.reports++;
+        if (report_has_motion) {
+            uint32_t latency = timer_elapsed32(report_since);
+            pointing_device_stats.motion_reports++;
+            if (latency > pointing_device_stats.max_latency_ms) {
+                pointing_device_stats.max_latency_ms = latency;
+            }
+        }
+#endif
     }
+#ifdef POINTING_DEVICE_STATS
+    report_has_motion = false;
+#endif
     // send it and 0 it out except for buttons, so those stay until they are explicity over-ridden using update_pointing_device
     uint8_t buttons = local_mouse_report.buttons;
     memset(&local_mouse_report, 0, sizeof(local_mouse_report));
@@ -267,6 +398,8 @@ __attribute__((weak)) bool pointing_device_task(void) {
 #else
     local_mouse_report = pointing_device_driver.get_report(local_mouse_report);
 #endif // defined(SPLIT_POINTING_ENABLE)
+    // Take motion the driver accumulated, also when the motion pin is idle so carried over motion is sent
+    pointing_device_drain_motion(&local_mouse_report);
 
     // allow kb to intercept and modify report
 #if defined(SPLIT_POINTING_ENABLE) && defined(POINTING_DEVICE_COMBINED)
@@ -99,6 +99,16 @@ typedef int32_t clamp_range_t;
 typedef int16_t clamp_range_t;
 #endif
 
+#ifdef POINTING_DEVICE_STATS
+typedef struct {
+    uint32_t samples;        // sensor readings added with pointing_device_accumulate_motion()
+    uint32_t reports;        // mouse reports sent
+    uint32_t motion_reports; // mouse reports sent that carried accumulated motion
+    uint32_t carried;        // times the motion did not fit in one report and was carried over
+    uint32_t max_latency_ms; // longest time from a reading to the report carrying it
+} pointing_device_stats_t;
+#endif
+
 void           pointing_device_init(void);
 bool           pointing_device_task(void);
 bool           pointing_device_send(void);
@@ -114,6 +124,12 @@ report_mouse_t pointing_device_task_user(report_mouse_t mouse_report);
 uint8_t        pointing_device_handle_buttons(uint8_t buttons, bool pressed, pointing_device_buttons_t button);
 report_mouse_t pointing_device_adjust_by_defines(report_mouse_t mouse_report);
 void           pointing_device_keycode_handler(uint16_t keycode, bool pressed);
+void           pointing_device_accumulate_motion(int16_t x, int16_t y);
+bool           pointing_device_drain_motion(report_mouse_t *mouse_report);
+#ifdef POINTING_DEVICE_STATS
+pointing_device_stats_t pointing_device_get_stats(void);
+void                    pointing_device_clear_stats(void);
+#endif
 
 #if defined(SPLIT_POINTING_ENABLE)
 void     pointing_device_set_shared_report(report_mouse_t report);
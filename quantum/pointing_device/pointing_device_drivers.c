@@ -365,8 +365,8 @@ report_mouse_t pmw33xx_get_report(report_mouse_t mouse_report) {
         pd_dprintf("PWM3360 (0): starting motion\n");
     }
 
-    mouse_report.x = CONSTRAIN_HID_XY(report.delta_x);
-    mouse_report.y = CONSTRAIN_HID_XY(report.delta_y);
+    // Motion beyond the report range is carried over to the next report instead of being clamped away
+    pointing_device_accumulate_motion(report.delta_x, report.delta_y);
     return mouse_report;
 }
 
@@ -16,6 +16,7 @@
 
 #include "process_combo.h"
 #include <stddef.h>
+#include <string.h>
 #include "process_auto_shift.h"
 #include "caps_word.h"
 #include "timer.h"
@@ -76,6 +77,7 @@ static uint16_t timer = 0;
 #endif
 static bool     b_combo_enable = true; // defaults to enabled
 static uint16_t longest_term   = 0;
+static bool     combo_touched  = false; // any combo state changed since the last clear
 
 typedef struct {
     keyrecord_t record;
@@ -194,6 +196,10 @@ static inline uint16_t _get_combo_term(uint16_t combo_index, combo_t *combo) {
 void clear_combos(void) {
     uint16_t index = 0;
     longest_term   = 0;
+    if (!combo_touched) {
+        return;
+    }
+    combo_touched = false;
     for (index = 0; index < combo_count(); ++index) {
         combo_t *combo = combo_get(index);
         if (!COMBO_ACTIVE(combo)) {
@@ -256,7 +262,6 @@ static inline void dump_key_buffer(void) {
     key_buffer_next = key_buffer_size = 0;
 }
 
-#define NO_COMBO_KEYS_ARE_DOWN (0 == COMBO_STATE(combo))
 #define ALL_COMBO_KEYS_ARE_DOWN(state, key_count) (((1 << key_count) - 1) == state)
 #define ONLY_ONE_KEY_IS_DOWN(state) !(state & (state - 1))
 #define KEY_NOT_YET_RELEASED(state, key_index) ((1 << key_index) & state)
@@ -423,6 +428,7 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
     if (-1 == (int16_t)key_index) {
         return false;
     }
+    combo_touched = true;
 
     bool key_is_part_of_combo = (!COMBO_DISABLED(combo) && is_combo_enabled()
 #if defined(COMBO_MUST_PRESS_IN_ORDER) || defined(COMBO_MUST_PRESS_IN_ORDER_PER_COMBO)
@@ -534,9 +540,84 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
     return key_is_part_of_combo;
 }
 
+#ifndef COMBO_NO_KEYCODE_INDEX
+/* Index of the combos each keycode is part of, so that an event only visits
+ * the combos containing its keycode. Built on the first event and whenever the
+ * number of combos changes or combo_keycode_index_invalidate() is called,
+ * falls back to scanning all combos if the combos hold more keys than
+ * combo_keycode_index_size(). */
+static uint16_t keycode_index_length = 0;
+static uint16_t keycode_index_combos = 0; // number of combos the index was built for
+static bool     keycode_index_built  = false;
+static bool     keycode_index_full   = false; // not every key fit, the index can't be used
+
+static void build_keycode_index(void) {
+    keycode_index_length = 0;
+    keycode_index_combos = combo_count();
+    keycode_index_built  = true;
+    keycode_index_full   = false;
+
+    for (uint16_t idx = 0; idx < keycode_index_combos; ++idx) {
+        for (const uint16_t *keys = combo_get(idx)->keys; pgm_read_word(keys) != COMBO_END; ++keys) {
+            uint16_t keycode = pgm_read_word(keys);
+
+            // Combos are added in ascending order, so the entry goes after all others of its keycode
+            uint16_t pos = keycode_index_length;
+            while (pos > 0 && combo_keycode_index[pos - 1].keycode > keycode) {
+                --pos;
+            }
+            if (pos > 0 && combo_keycode_index[pos - 1].keycode == keycode && combo_keycode_index[pos - 1].combo_index == idx) {
+                continue; // a key may be listed twice in a combo
+            }
+            if (keycode_index_length == combo_keycode_index_size()) {
+                keycode_index_full = true;
+                return;
+            }
+
+            memmove(&combo_keycode_index[pos + 1], &combo_keycode_index[pos], (keycode_index_length - pos) * sizeof(combo_keycode_entry_t));
+            combo_keycode_index[pos] = (combo_keycode_entry_t){.keycode = keycode, .combo_index = idx};
+            ++keycode_index_length;
+        }
+    }
+}
+
+/* Returns the range of entries for the keycode, false when the index isn't
+ * available and all combos have to be checked. */
+static bool find_keycode_combos(uint16_t keycode, const combo_keycode_entry_t **first, const combo_keycode_entry_t **last) {
+    if (!keycode_index_built || keycode_index_combos != combo_count()) {
+        build_keycode_index();
+    }
+    if (keycode_index_full) {
+        return false;
+    }
+
+    uint16_t low = 0, high = keycode_index_length;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (combo_keycode_index[mid].keycode < keycode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    uint16_t end = low;
+    while (end < keycode_index_length && combo_keycode_index[end].keycode == keycode) {
+        ++end;
+    }
+    *first = &combo_keycode_index[low];
+    *last  = &combo_keycode_index[end];
+    return true;
+}
+#endif // COMBO_NO_KEYCODE_INDEX
+
+void combo_keycode_index_invalidate(void) {
+#ifndef COMBO_NO_KEYCODE_INDEX
+    keycode_index_built = false;
+#endif
+}
+
 bool process_combo(uint16_t keycode, keyrecord_t *record) {
-    bool is_combo_key          = false;
-    bool no_combo_keys_pressed = true;
+    bool is_combo_key = false;
 
     if (keycode == QK_COMBO_ON && record->event.pressed) {
         combo_enable();
@@ -564,10 +645,18 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     }
 #endif
 
-    for (uint16_t idx = 0; idx < combo_count(); ++idx) {
-        combo_t *combo = combo_get(idx);
-        is_combo_key |= process_single_combo(combo, keycode, record, idx);
-        no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+#ifndef COMBO_NO_KEYCODE_INDEX
+    const combo_keycode_entry_t *first, *last;
+    if (find_keycode_combos(keycode, &first, &last)) {
+        for (; first != last; ++first) {
+            is_combo_key |= process_single_combo(combo_get(first->combo_index), keycode, record, first->combo_index);
+        }
+    } else
+#endif
+    {
+        for (uint16_t idx = 0; idx < combo_count(); ++idx) {
+            is_combo_key |= process_single_combo(combo_get(idx), keycode, record, idx);
+        }
     }
 
     if (record->event.pressed && is_combo_key) {
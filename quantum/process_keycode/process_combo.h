@@ -38,6 +38,16 @@
 #ifndef COMBO_BUFFER_LENGTH
 #    define COMBO_BUFFER_LENGTH 4
 #endif
+#ifndef COMBO_KEYCODE_INDEX_LENGTH
+#    if defined(__AVR__)
+#        define COMBO_KEYCODE_INDEX_LENGTH 32
+#    else
+#        define COMBO_KEYCODE_INDEX_LENGTH 128
+#    endif
+#endif
+#ifndef COMBO_KEYCODE_INDEX_KEYS
+#    define COMBO_KEYCODE_INDEX_KEYS 3
+#endif
 
 typedef struct combo_t {
     const uint16_t *keys;
@@ -57,6 +67,17 @@ typedef struct combo_t {
 #endif
 } combo_t;
 
+#ifndef COMBO_NO_KEYCODE_INDEX
+typedef struct {
+    uint16_t keycode;
+    uint16_t combo_index;
+} combo_keycode_entry_t;
+
+// Storage of the keycode index, sized from the keymap's combos in keymap_introspection.c
+extern combo_keycode_entry_t combo_keycode_index[];
+uint16_t                     combo_keycode_index_size(void);
+#endif
+
 #define COMBO(ck, ca) \
     { .keys = &(ck)[0], .keycode = (ca) }
 #define COMBO_ACTION(ck) \
@@ -81,3 +102,4 @@ void combo_enable(void);
 void combo_disable(void);
 void combo_toggle(void);
 bool is_combo_enabled(void);
+void combo_keycode_index_invalidate(void);
@@ -13,6 +13,8 @@ bool ALPHAS_MODS(effect_params_t* params) {
 
     for (uint8_t i = led_min; i < led_max; i++) {
         RGB_MATRIX_TEST_LED_FLAGS();
+        // Only depends on the settings, so an LED keeps its color until these change
+        if (!rgb_matrix_led_needs_redraw(i)) continue;
         if (HAS_FLAGS(g_led_config.flags[i], LED_FLAG_MODIFIER)) {
             rgb_matrix_set_color(i, rgb2.r, rgb2.g, rgb2.b);
         } else {
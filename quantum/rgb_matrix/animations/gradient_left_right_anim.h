@@ -9,6 +9,8 @@ bool GRADIENT_LEFT_RIGHT(effect_params_t* params) {
     uint8_t scale = scale8(64, rgb_matrix_config.speed);
     for (uint8_t i = led_min; i < led_max; i++) {
         RGB_MATRIX_TEST_LED_FLAGS();
+        // Only depends on the settings, so an LED keeps its color until these change
+        if (!rgb_matrix_led_needs_redraw(i)) continue;
         // The x range will be 0..224, map this to 0..7
         // Relies on hue being 8-bit and wrapping
         hsv.h   = rgb_matrix_config.hsv.h + (scale * g_led_config.point[i].x >> 5);
@@ -0,0 +1,26 @@
+#pragma once
+
+#ifdef RGB_MATRIX_LED_GEOMETRY
+
+typedef HSV (*led_geometry_f)(HSV hsv, uint8_t i, uint8_t time);
+
+// Same timing as effect_runner_dx_dy(), for effects that read led_center_dist[i] and led_center_angle[i]
+bool effect_runner_led_geometry(effect_params_t* params, led_geometry_f effect_func) {
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+
+    if (params->init) {
+        // Pick up changes the keyboard made to g_led_config after rgb_matrix_init()
+        led_geometry_init();
+    }
+
+    rgb_matrix_batch_t batch = {.count = 0};
+    uint8_t            time  = scale16by8(g_rgb_timer, rgb_matrix_config.speed / 2);
+    for (uint8_t i = led_min; i < led_max; i++) {
+        RGB_MATRIX_TEST_LED_FLAGS();
+        rgb_matrix_batch_add(&batch, i, effect_func(rgb_matrix_config.hsv, i, time));
+    }
+    rgb_matrix_batch_flush(&batch);
+    return rgb_matrix_check_finished_leds(led_max);
+}
+
+#endif // RGB_MATRIX_LED_GEOMETRY
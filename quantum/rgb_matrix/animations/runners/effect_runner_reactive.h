@@ -6,8 +6,13 @@ typedef HSV (*reactive_f)(HSV hsv, uint16_t offset);
 
 bool effect_runner_reactive(effect_params_t* params, reactive_f effect_func) {
     RGB_MATRIX_USE_LIMITS(led_min, led_max);
+#    if defined(RGB_MATRIX_INCREMENTAL_RENDER) && !defined(RGB_MATRIX_SOLID_REACTIVE_GRADIENT_MODE)
+    // LEDs already showing the color they settle at once their last hit faded out
+    static uint8_t settled[(RGB_MATRIX_LED_COUNT + 7) / 8];
+#    endif
 
-    uint16_t max_tick = 65535 / qadd8(rgb_matrix_config.speed, 1);
+    rgb_matrix_batch_t batch    = {.count = 0};
+    uint16_t           max_tick = 65535 / qadd8(rgb_matrix_config.speed, 1);
     for (uint8_t i = led_min; i < led_max; i++) {
         RGB_MATRIX_TEST_LED_FLAGS();
         uint16_t tick = max_tick;
@@ -19,10 +24,20 @@ bool effect_runner_reactive(effect_params_t* params, reactive_f effect_func) {
             }
         }
 
+#    if defined(RGB_MATRIX_INCREMENTAL_RENDER) && !defined(RGB_MATRIX_SOLID_REACTIVE_GRADIENT_MODE)
+        // Without the gradient mode the color only depends on the offset, which stops changing at max_tick
+        if (tick < max_tick) {
+            settled[i / 8] &= ~(1 << (i % 8));
+        } else if (!(settled[i / 8] & (1 << (i % 8))) || rgb_matrix_led_needs_redraw(i)) {
+            settled[i / 8] |= 1 << (i % 8);
+        } else {
+            continue;
+        }
+#    endif
         uint16_t offset = scale16by8(tick, qadd8(rgb_matrix_config.speed, 1));
-        RGB      rgb    = rgb_matrix_hsv_to_rgb(effect_func(rgb_matrix_config.hsv, offset));
-        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+        rgb_matrix_batch_add(&batch, i, effect_func(rgb_matrix_config.hsv, offset));
     }
+    rgb_matrix_batch_flush(&batch);
     return rgb_matrix_check_finished_leds(led_max);
 }
 
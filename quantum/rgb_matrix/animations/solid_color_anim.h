@@ -7,6 +7,8 @@ bool SOLID_COLOR(effect_params_t* params) {
     RGB rgb = rgb_matrix_hsv_to_rgb(rgb_matrix_config.hsv);
     for (uint8_t i = led_min; i < led_max; i++) {
         RGB_MATRIX_TEST_LED_FLAGS();
+        // Only depends on the settings, so an LED keeps its color until these change
+        if (!rgb_matrix_led_needs_redraw(i)) continue;
         rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
     }
     return rgb_matrix_check_finished_leds(led_max);
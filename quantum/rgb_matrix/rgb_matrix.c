@@ -29,6 +29,13 @@
 
 #include <lib/lib8tion/lib8tion.h>
 
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+#    if !defined(PROTOCOL_CHIBIOS)
+#        error "RGB_MATRIX_ASYNC_FLUSH is only supported on ChibiOS"
+#    endif
+#    include <ch.h>
+#endif
+
 #ifndef RGB_MATRIX_CENTER
 const led_point_t k_rgb_matrix_center = {112, 32};
 #else
@@ -39,6 +46,123 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
     return hsv_to_rgb(hsv);
 }
 
+__attribute__((weak)) void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    // Goes through rgb_matrix_hsv_to_rgb() so that overriding it is enough
+    for (uint8_t i = 0; i < count; i++) {
+        rgb[i] = rgb_matrix_hsv_to_rgb(hsv[i]);
+    }
+}
+
+#ifndef RGB_MATRIX_BATCH_SIZE
+#    define RGB_MATRIX_BATCH_SIZE 16
+#endif
+
+// Colors the effect runners have computed but not yet converted and sent to the driver
+typedef struct {
+    uint8_t count;
+    uint8_t led[RGB_MATRIX_BATCH_SIZE];
+    HSV     hsv[RGB_MATRIX_BATCH_SIZE];
+} rgb_matrix_batch_t;
+
+static void rgb_matrix_batch_flush(rgb_matrix_batch_t *batch) {
+    RGB rgb[RGB_MATRIX_BATCH_SIZE];
+    rgb_matrix_hsv_to_rgb_batch(batch->hsv, rgb, batch->count);
+    for (uint8_t i = 0; i < batch->count; i++) {
+        rgb_matrix_set_color(batch->led[i], rgb[i].r, rgb[i].g, rgb[i].b);
+    }
+    batch->count = 0;
+}
+
+static inline void rgb_matrix_batch_add(rgb_matrix_batch_t *batch, uint8_t led, HSV hsv) {
+    batch->led[batch->count] = led;
+    batch->hsv[batch->count] = hsv;
+    if (++batch->count == RGB_MATRIX_BATCH_SIZE) {
+        rgb_matrix_batch_flush(batch);
+    }
+}
+
+#if defined(ENABLE_RGB_MATRIX_CYCLE_OUT_IN) || defined(ENABLE_RGB_MATRIX_CYCLE_OUT_IN_DUAL) || defined(ENABLE_RGB_MATRIX_CYCLE_PINWHEEL) || defined(ENABLE_RGB_MATRIX_CYCLE_SPIRAL) || defined(ENABLE_RGB_MATRIX_BAND_PINWHEEL_SAT) || defined(ENABLE_RGB_MATRIX_BAND_PINWHEEL_VAL) || defined(ENABLE_RGB_MATRIX_BAND_SPIRAL_SAT) || defined(ENABLE_RGB_MATRIX_BAND_SPIRAL_VAL)
+#    define RGB_MATRIX_LED_GEOMETRY
+#endif
+
+#ifdef RGB_MATRIX_LED_GEOMETRY
+// Distance and angle of each LED from k_rgb_matrix_center, so that effects don't call sqrt16() and atan2_8() every frame
+static uint8_t led_center_dist[RGB_MATRIX_LED_COUNT];
+static uint8_t led_center_angle[RGB_MATRIX_LED_COUNT];
+#    ifdef ENABLE_RGB_MATRIX_CYCLE_OUT_IN_DUAL
+// Distance from the center of the nearer half of the board
+static uint8_t led_center_dual_dist[RGB_MATRIX_LED_COUNT];
+#    endif
+
+static void led_geometry_init(void) {
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        int16_t dx          = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy          = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        led_center_dist[i]  = sqrt16(dx * dx + dy * dy);
+        led_center_angle[i] = atan2_8(dy, dx);
+#    ifdef ENABLE_RGB_MATRIX_CYCLE_OUT_IN_DUAL
+        dx                      = (k_rgb_matrix_center.x / 2) - abs8(dx);
+        led_center_dual_dist[i] = sqrt16(dx * dx + dy * dy);
+#    endif
+    }
+}
+#endif // RGB_MATRIX_LED_GEOMETRY
+
+#ifdef RGB_MATRIX_LED_DISTANCE_CACHE
+#    ifndef RGB_MATRIX_LED_DISTANCE_CACHE_SIZE
+#        define RGB_MATRIX_LED_DISTANCE_CACHE_SIZE LED_HITS_TO_REMEMBER
+#    endif
+#    if defined(RGB_MATRIX_KEYREACTIVE_ENABLED) && RGB_MATRIX_LED_DISTANCE_CACHE_SIZE < LED_HITS_TO_REMEMBER
+#        error "RGB_MATRIX_LED_DISTANCE_CACHE_SIZE must be at least LED_HITS_TO_REMEMBER"
+#    endif
+
+// Distances from one LED to every LED, built the first time a splash or the heatmap needs them
+static uint8_t led_distance_rows[RGB_MATRIX_LED_DISTANCE_CACHE_SIZE][RGB_MATRIX_LED_COUNT];
+static uint8_t led_distance_keys[RGB_MATRIX_LED_DISTANCE_CACHE_SIZE];
+static uint8_t led_distance_next = 0;
+
+static bool led_distance_row_in_use(uint8_t led) {
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+    for (uint8_t j = 0; j < g_last_hit_tracker.count; j++) {
+        if (g_last_hit_tracker.index[j] == led) {
+            return true;
+        }
+    }
+#    endif
+    return false;
+}
+
+/**
+ * \brief Get the distances from `led` to every LED.
+ *
+ * Rows of LEDs in g_last_hit_tracker are never evicted, so the rows of all current hits stay valid together.
+ */
+static const uint8_t *led_distance_row(uint8_t led) {
+    for (uint8_t slot = 0; slot < RGB_MATRIX_LED_DISTANCE_CACHE_SIZE; slot++) {
+        if (led_distance_keys[slot] == led) {
+            return led_distance_rows[slot];
+        }
+    }
+
+    uint8_t slot = led_distance_next;
+    for (uint8_t n = 0; n < RGB_MATRIX_LED_DISTANCE_CACHE_SIZE; n++) {
+        slot = (led_distance_next + n) % RGB_MATRIX_LED_DISTANCE_CACHE_SIZE;
+        if (led_distance_keys[slot] == NO_LED || !led_distance_row_in_use(led_distance_keys[slot])) {
+            break;
+        }
+    }
+    led_distance_next = (slot + 1) % RGB_MATRIX_LED_DISTANCE_CACHE_SIZE;
+
+    led_distance_keys[slot] = led;
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        int16_t dx                 = g_led_config.point[i].x - g_led_config.point[led].x;
+        int16_t dy                 = g_led_config.point[i].y - g_led_config.point[led].y;
+        led_distance_rows[slot][i] = sqrt16(dx * dx + dy * dy);
+    }
+    return led_distance_rows[slot];
+}
+#endif // RGB_MATRIX_LED_DISTANCE_CACHE
+
 // Generic effect runners
 #include "rgb_matrix_runners.inc"
 
@@ -110,6 +234,30 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
 #    define RGB_MATRIX_DEFAULT_SPD UINT8_MAX / 2
 #endif
 
+#ifdef RGB_MATRIX_GOVERNOR
+#    if !defined(RGB_MATRIX_GOVERNOR_TYPING_TIMEOUT)
+#        define RGB_MATRIX_GOVERNOR_TYPING_TIMEOUT 1000
+#    endif
+#    if !defined(RGB_MATRIX_GOVERNOR_LOAD)
+#        define RGB_MATRIX_GOVERNOR_LOAD 10
+#    endif
+#    if !defined(RGB_MATRIX_GOVERNOR_STEP_US)
+#        define RGB_MATRIX_GOVERNOR_STEP_US 250
+#    endif
+#    if !defined(RGB_MATRIX_GOVERNOR_MAX_FLUSH_LIMIT)
+#        define RGB_MATRIX_GOVERNOR_MAX_FLUSH_LIMIT (RGB_MATRIX_LED_FLUSH_LIMIT * 4)
+#    endif
+#    if RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT
+#        define RGB_MATRIX_GOVERNOR_CHUNK RGB_MATRIX_LED_PROCESS_LIMIT
+#    else
+#        define RGB_MATRIX_GOVERNOR_CHUNK RGB_MATRIX_LED_COUNT
+#    endif
+// Render steps and frames to measure before adjusting. The timer only counts milliseconds,
+// so a single step or frame says little, but the average over many of them is accurate.
+#    define RGB_MATRIX_GOVERNOR_SAMPLES 32
+#    define RGB_MATRIX_GOVERNOR_FRAMES 4
+#endif // RGB_MATRIX_GOVERNOR
+
 // globals
 rgb_config_t rgb_matrix_config; // TODO: would like to prefix this with g_ for global consistancy, do this in another pr
 uint32_t     g_rgb_timer;
@@ -119,9 +267,20 @@ uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 last_hit_t g_last_hit_tracker;
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
+#ifdef RGB_MATRIX_GOVERNOR
+uint16_t g_rgb_led_process_limit = RGB_MATRIX_GOVERNOR_CHUNK;
+#endif // RGB_MATRIX_GOVERNOR
 
 // internals
 static bool            suspend_state     = false;
+#ifdef RGB_MATRIX_INCREMENTAL_RENDER
+static bool    rgb_effect_rendering = false; // set while the effect itself draws
+static bool    rgb_frame_changed    = false; // an LED was set since the frame started
+static uint8_t rgb_leds_stale[(RGB_MATRIX_LED_COUNT + 7) / 8];     // LEDs the effect has to redraw in this frame
+static uint8_t rgb_leds_drawn_over[(RGB_MATRIX_LED_COUNT + 7) / 8]; // LEDs something other than the effect set since the frame started
+static HSV     rgb_last_hsv;
+static uint8_t rgb_last_speed;
+#endif // RGB_MATRIX_INCREMENTAL_RENDER
 static uint8_t         rgb_last_enable   = UINT8_MAX;
 static uint8_t         rgb_last_effect   = UINT8_MAX;
 static effect_params_t rgb_effect_params = {0, LED_FLAG_ALL, false};
@@ -192,15 +351,64 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+// The driver flush runs on its own thread, which sleeps while the I2C/SPI
+// peripheral transfers the frame so the main loop keeps scanning meanwhile.
+// Rendering only resumes once the flush is done, the driver buffers are
+// never written while they are being sent.
+static THD_WORKING_AREA(rgb_flush_thread_wa, RGB_MATRIX_ASYNC_FLUSH_STACK_SIZE);
+static BSEMAPHORE_DECL(rgb_flush_request, true);
+static BSEMAPHORE_DECL(rgb_flush_done, false); // taken while a frame is being sent
+static volatile bool rgb_flush_pending = false;
+
+static THD_FUNCTION(rgb_flush_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("rgb_flush");
+    while (true) {
+        chBSemWait(&rgb_flush_request);
+        rgb_matrix_driver.flush();
+        rgb_flush_pending = false;
+        chBSemSignal(&rgb_flush_done);
+    }
+}
+
+// Sleeps until the flush thread is done, whatever the priority of the two threads
+static void rgb_flush_wait(void) {
+    chBSemWait(&rgb_flush_done);
+    chBSemSignal(&rgb_flush_done);
+}
+
+static void rgb_flush_start(void) {
+    chBSemWait(&rgb_flush_done);
+    rgb_flush_pending = true;
+    chBSemSignal(&rgb_flush_request);
+}
+#endif // RGB_MATRIX_ASYNC_FLUSH
+
 void rgb_matrix_update_pwm_buffers(void) {
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+    rgb_flush_wait();
+#endif // RGB_MATRIX_ASYNC_FLUSH
     rgb_matrix_driver.flush();
 }
 
 void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_INCREMENTAL_RENDER
+    rgb_frame_changed = true;
+    if (!rgb_effect_rendering && index >= 0 && index < RGB_MATRIX_LED_COUNT) {
+        rgb_leds_drawn_over[index / 8] |= 1 << (index % 8);
+    }
+#endif // RGB_MATRIX_INCREMENTAL_RENDER
     rgb_matrix_driver.set_color(index, red, green, blue);
 }
 
 void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_INCREMENTAL_RENDER
+    rgb_frame_changed = true;
+    if (!rgb_effect_rendering) {
+        memset(rgb_leds_drawn_over, 0xFF, sizeof(rgb_leds_drawn_over));
+    }
+#endif // RGB_MATRIX_INCREMENTAL_RENDER
 #if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
     for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++)
         rgb_matrix_set_color(i, red, green, blue);
@@ -321,16 +529,124 @@ static void rgb_task_timers(void) {
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
 }
 
+#ifdef RGB_MATRIX_GOVERNOR
+static uint16_t rgb_governor_flush_limit = RGB_MATRIX_LED_FLUSH_LIMIT;
+static uint32_t rgb_governor_window_start;
+static uint16_t rgb_governor_busy_ms;      // time spent rendering and flushing in this window
+static uint16_t rgb_governor_render_ms;    // of which rendering
+static uint16_t rgb_governor_render_steps; // number of rgb_task_render() calls in this window
+static uint8_t  rgb_governor_frames;       // number of frames started in this window
+
+/**
+ * \brief Adds the time one render or flush step took.
+ *
+ * Steps mostly take less than the 1ms timer resolution, so `elapsed` is 0 or 1. On
+ * average it still adds up to the time spent, as long as enough steps are counted.
+ */
+static void rgb_governor_measure(rgb_task_states state, uint32_t elapsed) {
+    if (state == RENDERING) {
+        rgb_governor_render_ms += elapsed;
+        rgb_governor_render_steps++;
+    }
+    rgb_governor_busy_ms += elapsed;
+}
+
+/**
+ * \brief Adjusts the frame rate and the render step size once enough steps and frames were measured.
+ *
+ * While keys are being used, the share of time spent on lighting is kept below
+ * RGB_MATRIX_GOVERNOR_LOAD percent by lowering the frame rate, and each render step is
+ * kept below RGB_MATRIX_GOVERNOR_STEP_US by rendering fewer LEDs per task run. Both go
+ * back to the configured values when the keyboard is idle.
+ */
+static void rgb_governor_update(void) {
+    if (last_input_activity_elapsed() >= RGB_MATRIX_GOVERNOR_TYPING_TIMEOUT) {
+        rgb_governor_flush_limit = RGB_MATRIX_LED_FLUSH_LIMIT;
+        g_rgb_led_process_limit  = RGB_MATRIX_GOVERNOR_CHUNK;
+    } else if (++rgb_governor_frames < RGB_MATRIX_GOVERNOR_FRAMES || rgb_governor_render_steps < RGB_MATRIX_GOVERNOR_SAMPLES) {
+        return;
+    } else {
+        uint32_t window_ms = timer_elapsed32(rgb_governor_window_start);
+        if (window_ms > 0) {
+            uint32_t load = (uint32_t)rgb_governor_busy_ms * 100 / window_ms;
+            if (load > RGB_MATRIX_GOVERNOR_LOAD) {
+                rgb_governor_flush_limit = MIN(rgb_governor_flush_limit + rgb_governor_flush_limit / 2, RGB_MATRIX_GOVERNOR_MAX_FLUSH_LIMIT);
+            } else if (load < RGB_MATRIX_GOVERNOR_LOAD / 2) {
+                rgb_governor_flush_limit = MAX(rgb_governor_flush_limit - rgb_governor_flush_limit / 4, RGB_MATRIX_LED_FLUSH_LIMIT);
+            }
+        }
+
+        uint32_t step_us = (uint32_t)rgb_governor_render_ms * 1000 / rgb_governor_render_steps;
+        if (step_us > RGB_MATRIX_GOVERNOR_STEP_US) {
+            g_rgb_led_process_limit = MAX(g_rgb_led_process_limit / 2, 1);
+        } else if (step_us < RGB_MATRIX_GOVERNOR_STEP_US / 2) {
+            g_rgb_led_process_limit = MIN(g_rgb_led_process_limit * 2, RGB_MATRIX_GOVERNOR_CHUNK);
+        }
+    }
+
+    rgb_governor_window_start = timer_read32();
+    rgb_governor_busy_ms      = 0;
+    rgb_governor_render_ms    = 0;
+    rgb_governor_render_steps = 0;
+    rgb_governor_frames       = 0;
+}
+#    define RGB_MATRIX_FRAME_LIMIT rgb_governor_flush_limit
+#else
+#    define RGB_MATRIX_FRAME_LIMIT RGB_MATRIX_LED_FLUSH_LIMIT
+#endif // RGB_MATRIX_GOVERNOR
+
 static void rgb_task_sync(void) {
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+    // still sending the previous frame
+    if (rgb_flush_pending) return;
+#endif // RGB_MATRIX_ASYNC_FLUSH
     eeconfig_flush_rgb_matrix(false);
     // next task
-    if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
+    if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_FRAME_LIMIT) rgb_task_state = STARTING;
 }
 
-static void rgb_task_start(void) {
+bool rgb_matrix_led_needs_redraw(uint8_t index) {
+#ifdef RGB_MATRIX_INCREMENTAL_RENDER
+    return rgb_leds_stale[index / 8] & (1 << (index % 8));
+#else
+    return true;
+#endif // RGB_MATRIX_INCREMENTAL_RENDER
+}
+
+#ifdef RGB_MATRIX_INCREMENTAL_RENDER
+/**
+ * \brief Works out which LEDs the effect has to redraw in the frame that is starting.
+ *
+ * Everything is redrawn when the effect or its settings changed, otherwise only the
+ * LEDs that were set by something other than the effect (e.g. indicators) since the
+ * previous frame started.
+ */
+static void rgb_task_start_stale(uint8_t effect) {
+    if (effect != rgb_last_effect || rgb_matrix_config.enable != rgb_last_enable || rgb_effect_params.flags != rgb_matrix_config.flags || rgb_matrix_config.hsv.h != rgb_last_hsv.h || rgb_matrix_config.hsv.s != rgb_last_hsv.s || rgb_matrix_config.hsv.v != rgb_last_hsv.v || rgb_matrix_config.speed != rgb_last_speed) {
+        memset(rgb_leds_stale, 0xFF, sizeof(rgb_leds_stale));
+    } else {
+        memcpy(rgb_leds_stale, rgb_leds_drawn_over, sizeof(rgb_leds_stale));
+    }
+    memset(rgb_leds_drawn_over, 0, sizeof(rgb_leds_drawn_over));
+    rgb_last_hsv      = rgb_matrix_config.hsv;
+    rgb_last_speed    = rgb_matrix_config.speed;
+    rgb_frame_changed = false;
+}
+#endif // RGB_MATRIX_INCREMENTAL_RENDER
+
+static void rgb_task_start(uint8_t effect) {
     // reset iter
     rgb_effect_params.iter = 0;
 
+#ifdef RGB_MATRIX_GOVERNOR
+    // the step size may only change between frames
+    rgb_governor_update();
+#endif // RGB_MATRIX_GOVERNOR
+
+#ifdef RGB_MATRIX_INCREMENTAL_RENDER
+    rgb_task_start_stale(effect);
+#endif // RGB_MATRIX_INCREMENTAL_RENDER
+
     // update double buffers
     g_rgb_timer = rgb_timer_buffer;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
@@ -407,7 +723,15 @@ static void rgb_task_flush(uint8_t effect) {
     rgb_last_enable = rgb_matrix_config.enable;
 
     // update pwm buffers
-    rgb_matrix_update_pwm_buffers();
+#ifdef RGB_MATRIX_INCREMENTAL_RENDER
+    // nothing to send if neither the effect nor anything else set an LED
+    if (rgb_frame_changed)
+#endif // RGB_MATRIX_INCREMENTAL_RENDER
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+        rgb_flush_start();
+#else
+        rgb_matrix_update_pwm_buffers();
+#endif // RGB_MATRIX_ASYNC_FLUSH
 
     // next task
     rgb_task_state = SYNCING;
@@ -426,12 +750,23 @@ void rgb_matrix_task(void) {
 
     uint8_t effect = suspend_backlight || !rgb_matrix_config.enable ? 0 : rgb_matrix_config.mode;
 
+#ifdef RGB_MATRIX_GOVERNOR
+    rgb_task_states governor_state = rgb_task_state;
+    uint32_t        governor_start = timer_read32();
+#endif // RGB_MATRIX_GOVERNOR
+
     switch (rgb_task_state) {
         case STARTING:
-            rgb_task_start();
+            rgb_task_start(effect);
             break;
         case RENDERING:
+#ifdef RGB_MATRIX_INCREMENTAL_RENDER
+            rgb_effect_rendering = true;
+            rgb_task_render(effect);
+            rgb_effect_rendering = false;
+#else
             rgb_task_render(effect);
+#endif // RGB_MATRIX_INCREMENTAL_RENDER
             if (effect) {
                 // Only run the basic indicators in the last render iteration (default there are 5 iterations)
                 if (rgb_effect_params.iter == RGB_MATRIX_LED_PROCESS_MAX_ITERATIONS) {
@@ -447,6 +782,12 @@ void rgb_matrix_task(void) {
             rgb_task_sync();
             break;
     }
+
+#ifdef RGB_MATRIX_GOVERNOR
+    if (governor_state == RENDERING || governor_state == FLUSHING) {
+        rgb_governor_measure(governor_state, timer_elapsed32(governor_start));
+    }
+#endif // RGB_MATRIX_GOVERNOR
 }
 
 void rgb_matrix_indicators(void) {
@@ -482,6 +823,17 @@ __attribute__((weak)) bool rgb_matrix_indicators_advanced_user(uint8_t led_min,
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
 
+#ifdef RGB_MATRIX_LED_GEOMETRY
+    led_geometry_init();
+#endif
+#ifdef RGB_MATRIX_LED_DISTANCE_CACHE
+    memset(led_distance_keys, NO_LED, sizeof(led_distance_keys));
+#endif
+
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+    chThdCreateStatic(rgb_flush_thread_wa, sizeof(rgb_flush_thread_wa), RGB_MATRIX_ASYNC_FLUSH_PRIORITY, rgb_flush_thread, NULL);
+#endif // RGB_MATRIX_ASYNC_FLUSH
+
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
     for (uint8_t i = 0; i < LED_HITS_TO_REMEMBER; ++i) {
@@ -511,8 +863,14 @@ void rgb_matrix_init(void) {
 void rgb_matrix_set_suspend_state(bool state) {
 #ifdef RGB_DISABLE_WHEN_USB_SUSPENDED
     if (state && !suspend_state) { // only run if turning off, and only once
-        rgb_task_render(0);        // turn off all LEDs when suspending
-        rgb_task_flush(0);         // and actually flash led state to LEDs
+#    ifdef RGB_MATRIX_ASYNC_FLUSH
+        rgb_flush_wait(); // the buffers are about to be overwritten
+#    endif
+        rgb_task_render(0); // turn off all LEDs when suspending
+        rgb_task_flush(0);  // and actually flash led state to LEDs
+#    ifdef RGB_MATRIX_ASYNC_FLUSH
+        rgb_flush_wait(); // the LEDs have to be off before the keyboard sleeps
+#    endif
     }
     suspend_state = state;
 #endif
@@ -48,24 +48,41 @@
 #    define RGB_MATRIX_LED_FLUSH_LIMIT 16
 #endif
 
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+#    ifndef RGB_MATRIX_ASYNC_FLUSH_STACK_SIZE
+#        define RGB_MATRIX_ASYNC_FLUSH_STACK_SIZE 512
+#    endif
+#    ifndef RGB_MATRIX_ASYNC_FLUSH_PRIORITY
+#        define RGB_MATRIX_ASYNC_FLUSH_PRIORITY (NORMALPRIO + 1)
+#    endif
+#endif
+
 #ifndef RGB_MATRIX_LED_PROCESS_LIMIT
 #    define RGB_MATRIX_LED_PROCESS_LIMIT ((RGB_MATRIX_LED_COUNT + 4) / 5)
 #endif
-#define RGB_MATRIX_LED_PROCESS_MAX_ITERATIONS ((RGB_MATRIX_LED_COUNT + RGB_MATRIX_LED_PROCESS_LIMIT - 1) / RGB_MATRIX_LED_PROCESS_LIMIT)
+#ifdef RGB_MATRIX_GOVERNOR
+// Number of LEDs rendered per task run, lowered by the governor while typing
+extern uint16_t g_rgb_led_process_limit;
+#    define RGB_MATRIX_LED_PROCESS_CHUNK g_rgb_led_process_limit
+#else
+#    define RGB_MATRIX_LED_PROCESS_CHUNK RGB_MATRIX_LED_PROCESS_LIMIT
+#endif
+#define RGB_MATRIX_LED_PROCESS_MAX_ITERATIONS ((RGB_MATRIX_LED_COUNT + RGB_MATRIX_LED_PROCESS_CHUNK - 1) / RGB_MATRIX_LED_PROCESS_CHUNK)
 
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT
+#if defined(RGB_MATRIX_GOVERNOR) || (defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT)
+// 16-bit so that the end of the last chunk of a matrix with close to 255 LEDs does not wrap before it is clamped
 #    if defined(RGB_MATRIX_SPLIT)
 #        define RGB_MATRIX_USE_LIMITS_ITER(min, max, iter)                                        \
-            uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * (iter);                                  \
-            uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;                                     \
+            uint16_t min = RGB_MATRIX_LED_PROCESS_CHUNK * (iter);                                 \
+            uint16_t max = min + RGB_MATRIX_LED_PROCESS_CHUNK;                                    \
             if (max > RGB_MATRIX_LED_COUNT) max = RGB_MATRIX_LED_COUNT;                           \
             uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;                                     \
             if (is_keyboard_left() && (max > k_rgb_matrix_split[0])) max = k_rgb_matrix_split[0]; \
             if (!(is_keyboard_left()) && (min < k_rgb_matrix_split[0])) min = k_rgb_matrix_split[0];
 #    else
-#        define RGB_MATRIX_USE_LIMITS_ITER(min, max, iter)       \
-            uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * (iter); \
-            uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;    \
+#        define RGB_MATRIX_USE_LIMITS_ITER(min, max, iter)        \
+            uint16_t min = RGB_MATRIX_LED_PROCESS_CHUNK * (iter); \
+            uint16_t max = min + RGB_MATRIX_LED_PROCESS_CHUNK;    \
             if (max > RGB_MATRIX_LED_COUNT) max = RGB_MATRIX_LED_COUNT;
 #    endif
 #else
@@ -127,6 +144,16 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
 void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
 void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue);
 
+// Color conversion used by the effects, both can be overridden. The batch version converts
+// `count` colors at once and calls rgb_matrix_hsv_to_rgb() for each by default.
+RGB  rgb_matrix_hsv_to_rgb(HSV hsv);
+void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count);
+
+// With RGB_MATRIX_INCREMENTAL_RENDER, effects only set the LEDs whose color changed since the
+// previous frame, plus the ones this returns true for: the effect or its settings changed, or
+// something else drew over the LED. Always true otherwise.
+bool rgb_matrix_led_needs_redraw(uint8_t index);
+
 void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed);
 
 void rgb_matrix_task(void);
@@ -0,0 +1,10 @@
+// Copyright 2026 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#define MATRIX_ROWS 4
+#define MATRIX_COLS 8
+
+#define SPLIT_TRANSPORT_BATCH
+#define SPLIT_TRANSPORT_MIRROR
+#define DISABLE_SYNC_TIMER
@@ -0,0 +1,52 @@
+// Copyright 2026 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+
+#include "mock.h"
+
+static split_shared_memory_t master_shmem;
+split_shared_memory_t *const split_shmem = &master_shmem;
+
+uint16_t mock_transaction_count[NUM_TOTAL_TRANSACTIONS];
+bool     mock_corrupt_m2s = false;
+bool     mock_corrupt_s2m = false;
+
+void mock_transport_reset(void) {
+    memset(mock_transaction_count, 0, sizeof(mock_transaction_count));
+    mock_corrupt_m2s = false;
+    mock_corrupt_s2m = false;
+}
+
+bool is_transport_connected(void) {
+    return true;
+}
+
+void split_shared_memory_lock(void) {}
+void split_shared_memory_unlock(void) {}
+
+static void mock_transfer(const split_transaction_desc_t *trans, uint16_t offset, uint8_t size, uint8_t *from, uint8_t *to, bool *corrupt) {
+    uint8_t len = split_trans_frame_size(trans, from + offset, size);
+    memcpy(to + offset, from + offset, len);
+    if (*corrupt && len > 1) {
+        to[offset + len - 1] ^= 0x01;
+        *corrupt = false;
+    }
+}
+
+// Behaves like the serial transport, with the slave answering straight away
+bool transport_execute_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    ++mock_transaction_count[id];
+    if (initiator2target_length > 0) {
+        size_t len = trans->initiator2target_buffer_size < initiator2target_length ? trans->initiator2target_buffer_size : initiator2target_length;
+        memcpy(split_trans_initiator2target_buffer(trans), initiator2target_buf, len);
+        mock_transfer(trans, trans->initiator2target_offset, trans->initiator2target_buffer_size, (uint8_t *)split_shmem, (uint8_t *)peer_split_shmem, &mock_corrupt_m2s);
+    }
+    if (target2initiator_length > 0) {
+        size_t len = trans->target2initiator_buffer_size < target2initiator_length ? trans->target2initiator_buffer_size : target2initiator_length;
+        mock_transfer(trans, trans->target2initiator_offset, trans->target2initiator_buffer_size, (uint8_t *)peer_split_shmem, (uint8_t *)split_shmem, &mock_corrupt_s2m);
+        memcpy(target2initiator_buf, split_trans_target2initiator_buffer(trans), len);
+    }
+    return true;
+}
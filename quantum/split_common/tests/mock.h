@@ -0,0 +1,20 @@
+// Copyright 2026 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "transactions.h"
+
+// The slave half, a second copy of transactions.c with its own state
+extern split_shared_memory_t *const peer_split_shmem;
+void                                peer_transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
+
+// Number of transfers per transaction id
+extern uint16_t mock_transaction_count[NUM_TOTAL_TRANSACTIONS];
+// Flips a bit of the next frame going that way, so that it fails its checksum
+extern bool mock_corrupt_m2s;
+extern bool mock_corrupt_s2m;
+
+void mock_transport_reset(void);
@@ -0,0 +1,21 @@
+// Copyright 2026 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Builds the slave half of the link from the same source, renaming everything
+// it exports so that both halves can live in one test binary.
+#define split_shmem peer_split_shmem
+#define split_transaction_table peer_split_transaction_table
+#define transactions_master peer_transactions_master
+#define transactions_slave peer_transactions_slave
+#define transaction_register_rpc peer_transaction_register_rpc
+#define transaction_rpc_exec peer_transaction_rpc_exec
+#define transport_execute_transaction peer_transport_execute_transaction
+
+#include "transactions.c"
+
+static split_shared_memory_t peer_shmem;
+split_shared_memory_t *const peer_split_shmem = &peer_shmem;
+
+bool peer_transport_execute_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+    return false;
+}
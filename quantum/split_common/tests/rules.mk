@@ -0,0 +1,11 @@
+split_transport_batch_DEFS := -DSPLIT_KEYBOARD -DSPLIT_COMMON_TRANSACTIONS -DPLATFORM_SUPPORTS_SYNCHRONIZATION -DNO_PRINT
+split_transport_batch_INC := $(QUANTUM_PATH)/split_common
+split_transport_batch_CONFIG := $(QUANTUM_PATH)/split_common/tests/config_mock.h
+
+split_transport_batch_SRC := \
+	platforms/test/timer.c \
+	$(QUANTUM_PATH)/crc.c \
+	$(QUANTUM_PATH)/split_common/tests/mock.c \
+	$(QUANTUM_PATH)/split_common/tests/mock_peer.c \
+	$(QUANTUM_PATH)/split_common/tests/transactions_batch_tests.cpp \
+	$(QUANTUM_PATH)/split_common/transactions.c
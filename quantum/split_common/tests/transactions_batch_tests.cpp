@@ -0,0 +1,172 @@
+// Copyright 2026 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "mock.h"
+}
+
+#define HALF_ROWS ((MATRIX_ROWS) / 2)
+#define IDLE_FRAME_LENGTH 2 // checksum and sequence only
+#define FRAME_SEQ(frame) ((frame).sequence >> 4)
+#define FRAME_ACK(frame) ((frame).sequence & 0x0F)
+
+class TransactionsBatch : public ::testing::Test {
+   protected:
+    // Both halves share the static state of their transactions.c copy, so the
+    // link stays up between tests and each test starts from a settled link.
+    void SetUp() override {
+        memset(master_local, 0, sizeof(master_local));
+        memset(slave_local, 0, sizeof(slave_local));
+        settle();
+        mock_transport_reset();
+    }
+
+    void sync() {
+        peer_transactions_slave(master_on_slave, slave_local);
+        transactions_master(master_local, slave_on_master);
+    }
+
+    void settle() {
+        for (int i = 0; i < 4; ++i) {
+            sync();
+        }
+    }
+
+    matrix_row_t master_local[HALF_ROWS]    = {0};
+    matrix_row_t slave_local[HALF_ROWS]     = {0};
+    matrix_row_t master_on_slave[HALF_ROWS] = {0};
+    matrix_row_t slave_on_master[HALF_ROWS] = {0};
+};
+
+TEST_F(TransactionsBatch, OnlyExchangesFrames) {
+    slave_local[1]  = 0x42;
+    master_local[0] = 0x24;
+    settle();
+
+    EXPECT_EQ(slave_on_master[1], 0x42);
+    EXPECT_EQ(master_on_slave[0], 0x24);
+    for (int id = 0; id < NUM_TOTAL_TRANSACTIONS; ++id) {
+        if (id != SPLIT_BATCH_SYNC) {
+            EXPECT_EQ(mock_transaction_count[id], 0) << "transaction " << id;
+        }
+    }
+    EXPECT_GT(mock_transaction_count[SPLIT_BATCH_SYNC], 0);
+}
+
+TEST_F(TransactionsBatch, IdleFramesCarryNoRecords) {
+    sync();
+    EXPECT_EQ(peer_split_shmem->batch_m2s.length, IDLE_FRAME_LENGTH);
+    EXPECT_EQ(split_shmem->batch_s2m.length, IDLE_FRAME_LENGTH);
+}
+
+TEST_F(TransactionsBatch, OnlyChangedBytesAreEncoded) {
+    master_local[1] = 0x81;
+    sync(); // the mirror handler stages the row after this exchange
+    sync();
+
+    const split_batch_frame_t &frame = peer_split_shmem->batch_m2s;
+    ASSERT_EQ(frame.length, IDLE_FRAME_LENGTH + 3 + 1);
+    EXPECT_EQ(frame.data[1], offsetof(split_shared_memory_t, mmatrix.matrix[1]) - offsetof(split_shared_memory_t, mmatrix));
+    EXPECT_EQ(frame.data[2], 1);
+    EXPECT_EQ(frame.data[3], 0x81);
+
+    // The slave applies the frame on its next cycle, the acknowledgement
+    // reaches the master after it already sent the frame again
+    sync();
+    EXPECT_EQ(master_on_slave[1], 0x81);
+    sync();
+    EXPECT_EQ(peer_split_shmem->batch_m2s.length, IDLE_FRAME_LENGTH);
+}
+
+TEST_F(TransactionsBatch, SequenceOnlyAdvancesOnNewPayload) {
+    sync();
+    uint8_t seq = FRAME_SEQ(peer_split_shmem->batch_m2s);
+    sync();
+    EXPECT_EQ(FRAME_SEQ(peer_split_shmem->batch_m2s), seq);
+
+    master_local[0] = 0x11;
+    sync();
+    sync();
+    EXPECT_NE(FRAME_SEQ(peer_split_shmem->batch_m2s), seq);
+    // The slave acknowledges the frame it applied
+    sync();
+    EXPECT_EQ(FRAME_ACK(split_shmem->batch_s2m), FRAME_SEQ(peer_split_shmem->batch_m2s));
+}
+
+TEST_F(TransactionsBatch, CorruptFrameToSlaveIsResent) {
+    master_local[0] = 0x5A;
+    sync();
+    mock_corrupt_m2s = true;
+    sync();
+
+    // The slave drops the frame and keeps acknowledging the previous one
+    uint8_t ack = FRAME_ACK(peer_split_shmem->batch_s2m);
+    peer_transactions_slave(master_on_slave, slave_local);
+    EXPECT_NE(master_on_slave[0], 0x5A);
+    EXPECT_EQ(FRAME_ACK(peer_split_shmem->batch_s2m), ack);
+
+    // Not acknowledged, so the change is still part of the next frame
+    transactions_master(master_local, slave_on_master);
+    sync();
+    EXPECT_EQ(master_on_slave[0], 0x5A);
+}
+
+TEST_F(TransactionsBatch, CorruptFrameToMasterIsRetried) {
+    slave_local[0] = 0xA5;
+    peer_transactions_slave(master_on_slave, slave_local);
+    mock_corrupt_s2m = true;
+    transactions_master(master_local, slave_on_master);
+
+    // The handler retries the exchange within the same cycle
+    EXPECT_EQ(slave_on_master[0], 0xA5);
+    EXPECT_EQ(mock_transaction_count[SPLIT_BATCH_SYNC], 2);
+}
+
+TEST_F(TransactionsBatch, ContinuousChangesStayIncremental) {
+    // The acknowledgement always refers to an older frame than the one just
+    // sent, the shadow still has to advance so that only the changes are sent
+    master_local[1] = 0x99;
+    for (uint8_t i = 1; i <= 8; ++i) {
+        master_local[0] = i;
+        sync();
+        if (i > 3) {
+            EXPECT_EQ(peer_split_shmem->batch_m2s.length, IDLE_FRAME_LENGTH + 3 + 1) << "cycle " << (int)i;
+        }
+    }
+    settle();
+    EXPECT_EQ(master_on_slave[0], 8);
+    EXPECT_EQ(master_on_slave[1], 0x99);
+}
+
+TEST_F(TransactionsBatch, RevertedBytesAreResent) {
+    master_local[0] = 0x55;
+    sync();
+    split_batch_frame_t stale = peer_split_shmem->batch_s2m;
+    sync();
+    peer_transactions_slave(master_on_slave, slave_local);
+    EXPECT_EQ(master_on_slave[0], 0x55);
+
+    // The acknowledgement of the frame carrying 0x55 is lost and the byte
+    // changes back to the acknowledged value before the slave answers again
+    peer_split_shmem->batch_s2m = stale;
+    master_local[0]             = 0x00;
+    transactions_master(master_local, slave_on_master);
+    transactions_master(master_local, slave_on_master);
+    settle();
+    EXPECT_EQ(master_on_slave[0], 0x00);
+}
+
+TEST_F(TransactionsBatch, UnstartedSlaveIsNotAnError) {
+    // A slave that has not encoded a frame yet answers with an empty one
+    memset(&peer_split_shmem->batch_s2m, 0, sizeof(peer_split_shmem->batch_s2m));
+    EXPECT_TRUE(transactions_master(master_local, slave_on_master));
+    EXPECT_EQ(mock_transaction_count[SPLIT_BATCH_SYNC], 1);
+
+    slave_local[0]  = 0x77;
+    master_local[0] = 0x66;
+    settle();
+    EXPECT_EQ(slave_on_master[0], 0x77);
+    EXPECT_EQ(master_on_slave[0], 0x66);
+}
@@ -80,8 +80,14 @@
     { 0, 0, sizeof_member(split_shared_memory_t, member), offsetof(split_shared_memory_t, member), cb }
 #define trans_target2initiator_initializer(member) trans_target2initiator_initializer_cb(member, NULL)
 
-#define transport_write(id, data, length) transport_execute_transaction(id, data, length, NULL, 0)
-#define transport_read(id, data, length) transport_execute_transaction(id, NULL, 0, data, length)
+#ifdef SPLIT_TRANSPORT_BATCH
+static bool batch_transport_execute(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length);
+#    define transport_write(id, data, length) batch_transport_execute(id, data, length, NULL, 0)
+#    define transport_read(id, data, length) batch_transport_execute(id, NULL, 0, data, length)
+#else // SPLIT_TRANSPORT_BATCH
+#    define transport_write(id, data, length) transport_execute_transaction(id, data, length, NULL, 0)
+#    define transport_read(id, data, length) transport_execute_transaction(id, NULL, 0, data, length)
+#endif // SPLIT_TRANSPORT_BATCH
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 // Forward-declare the RPC callback handlers
@@ -170,6 +176,357 @@ inline static bool send_if_data_mismatch(int8_t trans_id, uint32_t *last_update,
     return send_if_condition(trans_id, last_update, (memcmp(source, equiv_shmem, length) != 0), source, length);
 }
 
+////////////////////////////////////////////////////
+// Batched transport
+
+#ifdef SPLIT_TRANSPORT_BATCH
+
+/*
+ * All fixed size transactions are grouped into regions of the shared memory,
+ * merging neighbouring transactions of the same direction. Instead of running
+ * each transaction on its own, the halves exchange a single frame per cycle
+ * that carries the spans of each region which changed since the last frame the
+ * other half acknowledged. Frames are numbered, a frame is only applied once
+ * and the receiver echoes the number back to acknowledge it. The
+ * acknowledgement usually refers to an older frame than the one just sent, so
+ * the last few sent frames are kept until one of them is acknowledged. Their
+ * bytes are resent until then, as the other half may have applied them. A half
+ * that has not received anything yet acknowledges zero, which makes the other
+ * half resend its regions in full.
+ *
+ * The master exchanges the frame first and then runs the regular handlers
+ * against its local copy of the shared memory, writes are staged for the next
+ * exchange. The slave applies the received frame before and encodes its own
+ * after running its handlers.
+ */
+
+_Static_assert(SPLIT_TRANSPORT_BATCH_SIZE <= 250, "SPLIT_TRANSPORT_BATCH_SIZE too large");
+
+#    define BATCH_HEADER_SIZE 2 // checksum and sequence
+#    define BATCH_RECORD_SIZE 3 // region, offset and length of a span
+#    define BATCH_REGION_MAX (SPLIT_TRANSPORT_BATCH_SIZE - BATCH_RECORD_SIZE)
+#    define BATCH_REGION_GAP 3 // padding allowed between transactions of one region
+#    define BATCH_SPAN_GAP 2   // unchanged bytes merged into a span, cheaper than a new record
+#    define BATCH_REGION_LIMIT 32 // regions are tracked in uint32_t bitmaps, the rest keep their own transactions
+#    define BATCH_NO_REGION 0xFF
+#    define BATCH_HISTORY 3 // sent frames waiting for an acknowledgement, it lags one frame behind
+#    define BATCH_SEQ(frame) ((frame)->sequence >> 4)
+#    define BATCH_ACK(frame) ((frame)->sequence & 0x0F)
+
+typedef struct {
+    uint16_t offset;
+    uint8_t  size;
+    bool     initiator2target;
+} batch_region_t;
+
+static batch_region_t batch_regions[NUM_TOTAL_TRANSACTIONS];
+static uint8_t        batch_region_count = 0;
+static uint8_t        batch_region_of[NUM_TOTAL_TRANSACTIONS];
+static bool           batch_ready = false;
+
+typedef struct {
+    split_batch_frame_t frame;
+    uint32_t            full; // regions sent in full by the frame
+} batch_sent_t;
+
+static uint8_t      batch_shadow[offsetof(split_shared_memory_t, batch_m2s)]; // outgoing regions as acknowledged by the other half
+static uint32_t     batch_unsynced = UINT32_MAX;                              // outgoing regions that have to be sent in full
+static batch_sent_t batch_sent[BATCH_HISTORY];                                // frames not acknowledged yet, oldest first
+static uint8_t      batch_sent_count       = 0;
+static bool         batch_sent_transferred = false; // the newest frame reached the transport
+static uint8_t      batch_received_seq     = 0;
+
+_Static_assert(sizeof(batch_unsynced) * 8 >= BATCH_REGION_LIMIT, "BATCH_REGION_LIMIT exceeds the region bitmaps");
+
+static bool batch_eligible(uint8_t id) {
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    if (trans->slave_callback || trans->framed) {
+        return false;
+    }
+    // Only plain one-way transfers can be batched
+    if ((trans->initiator2target_buffer_size > 0) == (trans->target2initiator_buffer_size > 0)) {
+        return false;
+    }
+    switch (id) {
+#    ifdef USE_I2C
+        case I2C_EXECUTE_CALLBACK:
+#    endif // USE_I2C
+#    ifndef DISABLE_SYNC_TIMER
+        case PUT_SYNC_TIMER: // timing sensitive, a frame would delay it by a cycle
+#    endif // DISABLE_SYNC_TIMER
+#    if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
+        case PUT_RPC_REQ_DATA:
+        case GET_RPC_RESP_DATA:
+#    endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
+            return false;
+        default:
+            return true;
+    }
+}
+
+static void batch_init(void) {
+    uint8_t region = BATCH_NO_REGION;
+    for (uint8_t id = 0; id < NUM_TOTAL_TRANSACTIONS; ++id) {
+        batch_region_of[id] = BATCH_NO_REGION;
+        if (!batch_eligible(id)) {
+            region = BATCH_NO_REGION;
+            continue;
+        }
+
+        split_transaction_desc_t *trans  = &split_transaction_table[id];
+        bool                      i2t    = trans->initiator2target_buffer_size > 0;
+        uint16_t                  offset = i2t ? trans->initiator2target_offset : trans->target2initiator_offset;
+        uint8_t                   size   = i2t ? trans->initiator2target_buffer_size : trans->target2initiator_buffer_size;
+
+        // Extend the previous region when this transaction directly follows it
+        if (region != BATCH_NO_REGION && batch_regions[region].initiator2target == i2t) {
+            batch_region_t *prev = &batch_regions[region];
+            uint16_t        end  = prev->offset + prev->size;
+            if (offset >= end && offset - end <= BATCH_REGION_GAP && offset + size - prev->offset <= BATCH_REGION_MAX) {
+                prev->size          = offset + size - prev->offset;
+                batch_region_of[id] = region;
+                continue;
+            }
+        }
+
+        // Too large for a frame or out of regions, keep using its own transaction
+        if (size > BATCH_REGION_MAX || batch_region_count >= BATCH_REGION_LIMIT) {
+            region = BATCH_NO_REGION;
+            continue;
+        }
+
+        region                = batch_region_count++;
+        batch_regions[region] = (batch_region_t){offset, size, i2t};
+        batch_region_of[id]   = region;
+    }
+    batch_ready = true;
+}
+
+static bool batch_transport_execute(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+    if (!batch_ready || batch_region_of[id] == BATCH_NO_REGION) {
+        return transport_execute_transaction(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length);
+    }
+
+    // Batched transactions only touch the local copy, the frame exchange does the rest
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    if (initiator2target_length > 0) {
+        size_t   len    = trans->initiator2target_buffer_size < initiator2target_length ? trans->initiator2target_buffer_size : initiator2target_length;
+        uint8_t *buffer = split_trans_initiator2target_buffer(trans);
+        if (buffer != initiator2target_buf) {
+            memcpy(buffer, initiator2target_buf, len);
+        }
+    }
+    if (target2initiator_length > 0) {
+        size_t len = trans->target2initiator_buffer_size < target2initiator_length ? trans->target2initiator_buffer_size : target2initiator_length;
+        memcpy(target2initiator_buf, split_trans_target2initiator_buffer(trans), len);
+    }
+    return true;
+}
+
+// Marks the bytes of a region that unacknowledged frames carried with another value than the current one.
+// The other half may have applied those frames, so these bytes have to be sent even if they match the shadow.
+static void batch_mark_pending(uint8_t *pending, uint8_t region, const uint8_t *current) {
+    memset(pending, 0, (BATCH_REGION_MAX + 7) / 8);
+    for (uint8_t i = 0; i < batch_sent_count; ++i) {
+        const uint8_t *data = batch_sent[i].frame.data;
+        uint8_t        used = batch_sent[i].frame.length - BATCH_HEADER_SIZE;
+        for (uint8_t pos = 0; pos + BATCH_RECORD_SIZE <= used; pos += BATCH_RECORD_SIZE + data[pos + 2]) {
+            if (data[pos] != region) {
+                continue;
+            }
+            for (uint8_t j = 0; j < data[pos + 2]; ++j) {
+                uint8_t offset = data[pos + 1] + j;
+                if (data[pos + BATCH_RECORD_SIZE + j] != current[offset]) {
+                    pending[offset / 8] |= 1 << (offset % 8);
+                }
+            }
+        }
+    }
+}
+
+// Appends the changed spans of a region, all or nothing. Returns the new number of used bytes.
+static uint8_t batch_encode_region(uint8_t *data, uint8_t used, uint8_t region, bool full) {
+    const batch_region_t *r       = &batch_regions[region];
+    const uint8_t        *current = split_shmem_offset_ptr(r->offset);
+    const uint8_t        *shadow  = &batch_shadow[r->offset];
+    uint8_t               pending[(BATCH_REGION_MAX + 7) / 8];
+    batch_mark_pending(pending, region, current);
+
+#    define BATCH_CHANGED(i) (current[i] != shadow[i] || (pending[(i) / 8] & (1 << ((i) % 8))))
+
+    uint8_t pos = used;
+    for (uint8_t start = 0; start < r->size;) {
+        if (!full && !BATCH_CHANGED(start)) {
+            ++start;
+            continue;
+        }
+
+        uint8_t end = full ? r->size : start + 1;
+        for (uint8_t i = end; i < r->size && i - end <= BATCH_SPAN_GAP; ++i) {
+            if (BATCH_CHANGED(i)) {
+                end = i + 1;
+            }
+        }
+
+        uint8_t len = end - start;
+        if (pos + BATCH_RECORD_SIZE + len > SPLIT_TRANSPORT_BATCH_SIZE) {
+            return used;
+        }
+        data[pos++] = region;
+        data[pos++] = start;
+        data[pos++] = len;
+        memcpy(&data[pos], &current[start], len);
+        pos += len;
+        start = end;
+    }
+    return pos;
+
+#    undef BATCH_CHANGED
+}
+
+static void batch_apply(uint8_t *destination, const split_batch_frame_t *frame, bool initiator2target) {
+    const uint8_t *data = frame->data;
+    uint8_t        used = frame->length - BATCH_HEADER_SIZE;
+    for (uint8_t pos = 0; pos + BATCH_RECORD_SIZE <= used;) {
+        uint8_t region = data[pos];
+        uint8_t offset = data[pos + 1];
+        uint8_t len    = data[pos + 2];
+        pos += BATCH_RECORD_SIZE;
+        if (region >= batch_region_count || batch_regions[region].initiator2target != initiator2target || offset + len > batch_regions[region].size || pos + len > used) {
+            return;
+        }
+        memcpy(destination + batch_regions[region].offset + offset, &data[pos], len);
+        pos += len;
+    }
+}
+
+// Refreshes the outgoing frame, keeping its number when the payload did not change
+static void batch_encode(split_batch_frame_t *frame, bool initiator2target) {
+    split_batch_frame_t next;
+    uint8_t             used = 0;
+    uint32_t            full = 0;
+    for (uint8_t region = 0; region < batch_region_count; ++region) {
+        if (batch_regions[region].initiator2target != initiator2target) {
+            continue;
+        }
+        bool    unsynced = batch_unsynced & (1UL << region);
+        uint8_t encoded  = batch_encode_region(next.data, used, region, unsynced);
+        if (unsynced && encoded != used) {
+            full |= 1UL << region;
+        }
+        used = encoded;
+    }
+
+    uint8_t seq = BATCH_SEQ(frame);
+    next.length = BATCH_HEADER_SIZE + used;
+    if (seq == 0 || frame->length != next.length || memcmp(frame->data, next.data, used) != 0) {
+        seq           = seq == 0x0F ? 1 : seq + 1;
+        next.sequence = seq << 4;
+
+        // A frame the other half never got can simply be replaced. Otherwise the
+        // oldest one is dropped when the history is full, its bytes can then
+        // only be synced again by sending everything.
+        if (batch_sent_count > 0 && !batch_sent_transferred) {
+            --batch_sent_count;
+        } else if (batch_sent_count == BATCH_HISTORY) {
+            memmove(&batch_sent[0], &batch_sent[1], sizeof(batch_sent[0]) * (BATCH_HISTORY - 1));
+            --batch_sent_count;
+            batch_unsynced = UINT32_MAX;
+        }
+        memcpy(&batch_sent[batch_sent_count].frame, &next, sizeof(next));
+        batch_sent[batch_sent_count].full = full;
+        ++batch_sent_count;
+        batch_sent_transferred = false;
+    }
+    next.sequence = seq << 4 | batch_received_seq;
+    next.checksum = crc8(&next.sequence, next.length - 1);
+    memcpy(frame, &next, next.length + 1);
+}
+
+static bool batch_decode(const split_batch_frame_t *frame, bool initiator2target) {
+    // The other half has not encoded a frame since it started, it is not synced yet
+    if (frame->length == 0) {
+        batch_unsynced = UINT32_MAX;
+        return true;
+    }
+
+    if (frame->length < BATCH_HEADER_SIZE || frame->length >= sizeof(split_batch_frame_t) || BATCH_SEQ(frame) == 0 || frame->checksum != crc8(&frame->sequence, frame->length - 1)) {
+        return false;
+    }
+
+    // The other half has not heard from us since it started, resend everything
+    bool restarted = BATCH_ACK(frame) == 0;
+    if (restarted) {
+        batch_unsynced = UINT32_MAX;
+    }
+
+    if (restarted || BATCH_SEQ(frame) != batch_received_seq) {
+        batch_apply((uint8_t *)split_shmem, frame, !initiator2target);
+        batch_received_seq = BATCH_SEQ(frame);
+    }
+
+    // Advance the shadow to the acknowledged frame, older frames are superseded by it
+    for (uint8_t i = 0; i < batch_sent_count; ++i) {
+        if (BATCH_SEQ(&batch_sent[i].frame) == BATCH_ACK(frame)) {
+            batch_apply(batch_shadow, &batch_sent[i].frame, initiator2target);
+            batch_unsynced &= ~batch_sent[i].full;
+            batch_sent_count -= i + 1;
+            memmove(&batch_sent[0], &batch_sent[i + 1], sizeof(batch_sent[0]) * batch_sent_count);
+            break;
+        }
+    }
+    return true;
+}
+
+static bool batch_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    split_batch_frame_t outgoing, incoming;
+    if (!batch_ready) {
+        batch_init();
+    }
+
+    memcpy(&outgoing, &split_shmem->batch_m2s, sizeof(outgoing));
+    batch_encode(&outgoing, true);
+    batch_sent_transferred = true;
+    if (!transport_execute_transaction(SPLIT_BATCH_SYNC, &outgoing, sizeof(outgoing), &incoming, sizeof(incoming))) {
+        return false;
+    }
+    return batch_decode(&incoming, true);
+}
+
+static void batch_receive_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    if (!batch_ready) {
+        batch_init();
+    }
+    // The frame encoded last is returned by this exchange
+    batch_sent_transferred = true;
+    batch_decode(&split_shmem->batch_m2s, false);
+}
+
+static void batch_send_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    batch_encode(&split_shmem->batch_s2m, false);
+}
+
+// clang-format off
+#    define TRANSACTIONS_BATCH_MASTER() TRANSACTION_HANDLER_MASTER(batch)
+#    define TRANSACTIONS_BATCH_RECEIVE_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(batch_receive)
+#    define TRANSACTIONS_BATCH_SEND_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(batch_send)
+#    define TRANSACTIONS_BATCH_REGISTRATIONS \
+    [SPLIT_BATCH_SYNC] = { \
+        sizeof_member(split_shared_memory_t, batch_m2s), offsetof(split_shared_memory_t, batch_m2s), \
+        sizeof_member(split_shared_memory_t, batch_s2m), offsetof(split_shared_memory_t, batch_s2m), \
+        NULL, true \
+    },
+// clang-format on
+
+#else // SPLIT_TRANSPORT_BATCH
+
+#    define TRANSACTIONS_BATCH_MASTER()
+#    define TRANSACTIONS_BATCH_RECEIVE_SLAVE()
+#    define TRANSACTIONS_BATCH_SEND_SLAVE()
+#    define TRANSACTIONS_BATCH_REGISTRATIONS
+
+#endif // SPLIT_TRANSPORT_BATCH
+
 ////////////////////////////////////////////////////
 // Slave matrix
 
@@ -735,6 +1092,7 @@ static void pointing_handlers_slave(matrix_row_t master_matrix[], matrix_row_t s
     }
 
     pointing.report = pointing_device_driver.get_report((report_mouse_t){0});
+    pointing_device_drain_motion(&pointing.report);
     // Now update the checksum given that the pointing has been written to
     pointing.checksum = crc8(&pointing.report, sizeof(report_mouse_t));
 
@@ -895,6 +1253,7 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
 #endif // USE_I2C
 
     // clang-format off
+    TRANSACTIONS_BATCH_REGISTRATIONS
     TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS
     TRANSACTIONS_MASTER_MATRIX_REGISTRATIONS
     TRANSACTIONS_ENCODERS_REGISTRATIONS
@@ -925,6 +1284,7 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
 };
 
 bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    TRANSACTIONS_BATCH_MASTER();
     TRANSACTIONS_SLAVE_MATRIX_MASTER();
     TRANSACTIONS_MASTER_MATRIX_MASTER();
     TRANSACTIONS_ENCODERS_MASTER();
@@ -948,6 +1308,7 @@ bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix
 }
 
 void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    TRANSACTIONS_BATCH_RECEIVE_SLAVE();
     TRANSACTIONS_SLAVE_MATRIX_SLAVE();
     TRANSACTIONS_MASTER_MATRIX_SLAVE();
     TRANSACTIONS_ENCODERS_SLAVE();
@@ -967,6 +1328,7 @@ void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[
     TRANSACTIONS_HAPTIC_SLAVE();
     TRANSACTIONS_ACTIVITY_SLAVE();
     TRANSACTIONS_DETECTED_OS_SLAVE();
+    TRANSACTIONS_BATCH_SEND_SLAVE();
 }
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
@@ -32,6 +32,7 @@ typedef struct _split_transaction_desc_t {
     uint8_t          target2initiator_buffer_size;
     uint16_t         target2initiator_offset;
     slave_callback_t slave_callback;
+    bool             framed;
 } split_transaction_desc_t;
 
 // Forward declaration for the split transactions
@@ -41,6 +42,16 @@ extern split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS];
 #define split_trans_initiator2target_buffer(trans) (split_shmem_offset_ptr((trans)->initiator2target_offset))
 #define split_trans_target2initiator_buffer(trans) (split_shmem_offset_ptr((trans)->target2initiator_offset))
 
+// Framed transactions only transfer the used part of their buffers, the first
+// byte of the buffer holds the number of bytes that follow it. Transports
+// receive that byte first and use this to size the remainder of the transfer.
+static inline uint8_t split_trans_frame_size(const split_transaction_desc_t *trans, const uint8_t *buffer, uint8_t buffer_size) {
+    if (!trans->framed || buffer_size == 0 || buffer[0] >= buffer_size) {
+        return buffer_size;
+    }
+    return buffer[0] + 1;
+}
+
 // returns false if valid data not received from slave
 bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
 void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
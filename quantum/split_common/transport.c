@@ -65,6 +65,7 @@ bool transport_execute_transaction(int8_t id, const void *initiator2target_buf,
     if (initiator2target_length > 0) {
         size_t len = trans->initiator2target_buffer_size < initiator2target_length ? trans->initiator2target_buffer_size : initiator2target_length;
         memcpy(split_trans_initiator2target_buffer(trans), initiator2target_buf, len);
+        len = split_trans_frame_size(trans, split_trans_initiator2target_buffer(trans), len);
         if ((status = i2c_writeReg(SLAVE_I2C_ADDRESS, trans->initiator2target_offset, split_trans_initiator2target_buffer(trans), len, SLAVE_I2C_TIMEOUT)) < 0) {
             return false;
         }
@@ -76,8 +77,18 @@ bool transport_execute_transaction(int8_t id, const void *initiator2target_buf,
     }
 
     if (target2initiator_length > 0) {
-        size_t len = trans->target2initiator_buffer_size < target2initiator_length ? trans->target2initiator_buffer_size : target2initiator_length;
-        if ((status = i2c_readReg(SLAVE_I2C_ADDRESS, trans->target2initiator_offset, split_trans_target2initiator_buffer(trans), len, SLAVE_I2C_TIMEOUT)) < 0) {
+        size_t   len    = trans->target2initiator_buffer_size < target2initiator_length ? trans->target2initiator_buffer_size : target2initiator_length;
+        uint8_t *buffer = split_trans_target2initiator_buffer(trans);
+        if (trans->framed) {
+            // Fetch the length byte first, then only the part of the frame in use
+            if ((status = i2c_readReg(SLAVE_I2C_ADDRESS, trans->target2initiator_offset, buffer, 1, SLAVE_I2C_TIMEOUT)) < 0) {
+                return false;
+            }
+            size_t used = split_trans_frame_size(trans, buffer, len);
+            if (used > 1 && (status = i2c_readReg(SLAVE_I2C_ADDRESS, trans->target2initiator_offset + 1, buffer + 1, used - 1, SLAVE_I2C_TIMEOUT)) < 0) {
+                return false;
+            }
+        } else if ((status = i2c_readReg(SLAVE_I2C_ADDRESS, trans->target2initiator_offset, buffer, len, SLAVE_I2C_TIMEOUT)) < 0) {
             return false;
         }
         memcpy(target2initiator_buf, split_trans_target2initiator_buffer(trans), len);
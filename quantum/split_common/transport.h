@@ -31,6 +31,10 @@
 #    define RPC_S2M_BUFFER_SIZE 32
 #endif // RPC_S2M_BUFFER_SIZE
 
+#ifndef SPLIT_TRANSPORT_BATCH_SIZE
+#    define SPLIT_TRANSPORT_BATCH_SIZE 32
+#endif // SPLIT_TRANSPORT_BATCH_SIZE
+
 void transport_master_init(void);
 void transport_slave_init(void);
 
@@ -146,6 +150,15 @@ typedef struct _rpc_sync_info_t {
 #    include "os_detection.h"
 #endif // defined(OS_DETECTION_ENABLE) && defined(SPLIT_DETECTED_OS_ENABLE)
 
+#ifdef SPLIT_TRANSPORT_BATCH
+typedef struct _split_batch_frame_t {
+    uint8_t length; // number of bytes following, only those are transferred
+    uint8_t checksum;
+    uint8_t sequence; // frame number in the high nibble, acknowledged frame in the low nibble
+    uint8_t data[SPLIT_TRANSPORT_BATCH_SIZE];
+} split_batch_frame_t;
+#endif // SPLIT_TRANSPORT_BATCH
+
 typedef struct _split_shared_memory_t {
 #ifdef USE_I2C
     int8_t transaction_id;
@@ -230,6 +243,11 @@ typedef struct _split_shared_memory_t {
 #if defined(OS_DETECTION_ENABLE) && defined(SPLIT_DETECTED_OS_ENABLE)
     os_variant_t detected_os;
 #endif // defined(OS_DETECTION_ENABLE) && defined(SPLIT_DETECTED_OS_ENABLE)
+
+#ifdef SPLIT_TRANSPORT_BATCH
+    split_batch_frame_t batch_m2s;
+    split_batch_frame_t batch_s2m;
+#endif // SPLIT_TRANSPORT_BATCH
 } split_shared_memory_t;
 
 extern split_shared_memory_t *const split_shmem;
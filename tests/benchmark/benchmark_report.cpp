@@ -0,0 +1,68 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "benchmark_report.hpp"
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t    events;
+    uint64_t    iterations;
+    uint64_t    cpu_ns;
+};
+
+std::vector<BenchmarkResult> results;
+
+uint64_t cpu_time_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+std::string to_json() {
+    std::ostringstream json;
+    json << "{\"benchmarks\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        json << (i ? "," : "") << "{\"name\":\"" << result.name << "\""
+             << ",\"events\":" << result.events << ",\"iterations\":" << result.iterations << ",\"cpu_ns\":" << result.cpu_ns
+             << ",\"ns_per_event\":" << (result.events ? result.cpu_ns / result.events : 0) << ",\"ns_per_iteration\":" << (result.iterations ? result.cpu_ns / result.iterations : 0) << "}";
+    }
+    json << "]}";
+    return json.str();
+}
+
+class BenchmarkEnvironment : public testing::Environment {
+   public:
+    void TearDown() override {
+        std::string json = to_json();
+        std::cout << json << std::endl;
+
+        const char* path = std::getenv("QMK_BENCHMARK_OUTPUT");
+        if (path) {
+            std::ofstream(path) << json << std::endl;
+        }
+    }
+};
+
+testing::Environment* const benchmark_environment = testing::AddGlobalTestEnvironment(new BenchmarkEnvironment);
+
+} // namespace
+
+CpuTimer::CpuTimer() : m_start(cpu_time_ns()) {}
+
+uint64_t CpuTimer::elapsed_ns() const {
+    return cpu_time_ns() - m_start;
+}
+
+void benchmark_report(const std::string& name, uint64_t events, uint64_t iterations, uint64_t cpu_ns) {
+    results.push_back({name, events, iterations, cpu_ns});
+}
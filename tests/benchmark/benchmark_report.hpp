@@ -0,0 +1,27 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Measures host CPU time spent by the current process.
+ */
+class CpuTimer {
+   public:
+    CpuTimer();
+    uint64_t elapsed_ns() const;
+
+   private:
+    uint64_t m_start;
+};
+
+/**
+ * @brief Adds a result to the report that is written once all tests finished.
+ *
+ * The report is printed to stdout as a single JSON object and additionally
+ * written to the file named by the `QMK_BENCHMARK_OUTPUT` environment variable.
+ */
+void benchmark_report(const std::string& name, uint64_t events, uint64_t iterations, uint64_t cpu_ns);
@@ -0,0 +1,12 @@
+# Copyright 2023 QMK
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+COMBO_ENABLE = yes
+KEY_OVERRIDE_ENABLE = yes
+AUTOCORRECT_ENABLE = yes
+RGB_MATRIX_ENABLE = yes
+RGB_MATRIX_DRIVER = custom
+
+INTROSPECTION_KEYMAP_C = benchmark_keymap.c
+
+SRC += test_rgb_matrix.c
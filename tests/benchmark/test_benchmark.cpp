@@ -0,0 +1,207 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "benchmark_report.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+
+extern "C" {
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::NiceMock;
+
+namespace {
+
+const char* const layout[] = {"qwertyuiop", "asdfghjkl;", "zxcvbnm,./"};
+
+const std::string pangrams = "the quick brown fox jumps over the lazy dog. pack my box with five dozen liquor jugs. ";
+
+struct TraceEvent {
+    uint32_t time;
+    uint8_t  col;
+    uint8_t  row;
+    bool     pressed;
+};
+
+} // namespace
+
+class Benchmark : public TestFixture {
+   protected:
+    void SetUp() override {
+        set_layout(false);
+        autocorrect_enable();
+        rgb_matrix_enable_noeeprom();
+        rgb_matrix_mode_noeeprom(RGB_MATRIX_CYCLE_LEFT_RIGHT);
+    }
+
+    /**
+     * @brief Maps the letters of `layout` to the first three rows, optionally with mod-taps on the home row.
+     */
+    void set_layout(bool home_row_mods) {
+        const uint16_t mod_taps[] = {LGUI_T(KC_A), LALT_T(KC_S), LCTL_T(KC_D), LSFT_T(KC_F), KC_G, KC_H, RSFT_T(KC_J), RCTL_T(KC_K), LALT_T(KC_L), RGUI_T(KC_SCLN)};
+
+        keymap.clear();
+        for (uint8_t row = 0; row < 3; ++row) {
+            for (uint8_t col = 0; col < MATRIX_COLS; ++col) {
+                char     c       = layout[row][col];
+                uint16_t keycode = c == ';' ? KC_SCLN : c == ',' ? KC_COMM : c == '.' ? KC_DOT : c == '/' ? KC_SLSH : KC_A + (c - 'a');
+                add_key(KeymapKey(0, col, row, home_row_mods && row == 1 ? mod_taps[col] : keycode));
+                positions[c] = {col, row};
+            }
+        }
+        add_key(KeymapKey(0, 0, 3, KC_LSFT));
+        add_key(KeymapKey(0, 1, 3, KC_BSPC));
+        add_key(KeymapKey(0, 2, 3, KC_SPC));
+        add_key(KeymapKey(0, 3, 3, KC_ENT));
+        positions['^']  = {0, 3};
+        positions['\b'] = {1, 3};
+        positions[' ']  = {2, 3};
+    }
+
+    /**
+     * @brief Appends a tap of `c` to the trace, keys overlap like they do when typing fast.
+     */
+    void tap(char c) {
+        auto     position = positions.at(c);
+        uint32_t hold     = 30 + next_random() % 80;
+        trace.push_back({now, position.first, position.second, true});
+        trace.push_back({now + hold, position.first, position.second, false});
+        now += 50 + next_random() % 80;
+    }
+
+    void type(const std::string& text) {
+        for (char c : text) {
+            tap(c);
+        }
+    }
+
+    /**
+     * @brief Appends keys pressed within a few milliseconds of each other and released together.
+     */
+    void chord(const std::string& keys) {
+        uint32_t time = now;
+        for (char c : keys) {
+            auto position = positions.at(c);
+            trace.push_back({time, position.first, position.second, true});
+            trace.push_back({now + 60, position.first, position.second, false});
+            time += 3;
+        }
+        now += 120;
+    }
+
+    /**
+     * @brief Holds `c` while the keys in `text` are typed.
+     */
+    void hold(char c, const std::string& text) {
+        auto position = positions.at(c);
+        trace.push_back({now, position.first, position.second, true});
+        now += 40;
+        type(text);
+        trace.push_back({now, position.first, position.second, false});
+        now += 80;
+    }
+
+    /**
+     * @brief Replays the trace through `keyboard_task` and reports the CPU time it took.
+     */
+    void run_trace() {
+        NiceMock<TestDriver> driver;
+        uint32_t             reports = 0;
+        ON_CALL(driver, send_keyboard_mock(_)).WillByDefault([&reports](report_keyboard_t&) { ++reports; });
+
+        std::stable_sort(trace.begin(), trace.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.time < b.time; });
+        uint32_t end        = trace.empty() ? 10000 : trace.back().time + TAPPING_TERM * 2;
+        uint64_t iterations = 0;
+        auto     next       = trace.begin();
+
+        CpuTimer timer;
+        for (uint32_t time = 0; time < end; ++time) {
+            for (; next != trace.end() && next->time <= time; ++next) {
+                if (next->pressed) {
+                    press_key(next->col, next->row);
+                } else {
+                    release_key(next->col, next->row);
+                }
+            }
+            keyboard_task();
+            advance_time(1);
+            ++iterations;
+        }
+        uint64_t cpu_ns = timer.elapsed_ns();
+
+        // A benchmark of a keyboard that did nothing would be meaningless
+        EXPECT_TRUE(next == trace.end());
+        EXPECT_EQ(iterations, end);
+        if (trace.empty()) {
+            EXPECT_EQ(reports, 0);
+        } else {
+            EXPECT_GE(reports, trace.size() / 2);
+        }
+
+        benchmark_report(testing::UnitTest::GetInstance()->current_test_info()->name(), trace.size(), iterations, cpu_ns);
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+
+    std::vector<TraceEvent> trace;
+
+   private:
+    uint32_t next_random() {
+        seed = seed * 1103515245 + 12345;
+        return seed >> 16;
+    }
+
+    std::map<char, std::pair<uint8_t, uint8_t>> positions;
+    uint32_t                                    now  = 0;
+    uint32_t                                    seed = 1;
+};
+
+TEST_F(Benchmark, idle) {
+    run_trace();
+}
+
+TEST_F(Benchmark, typing) {
+    for (int i = 0; i < 20; ++i) {
+        type(pangrams);
+    }
+    run_trace();
+}
+
+TEST_F(Benchmark, typing_home_row_mods) {
+    set_layout(true);
+    for (int i = 0; i < 20; ++i) {
+        type(pangrams);
+    }
+    run_trace();
+}
+
+TEST_F(Benchmark, combos) {
+    for (int i = 0; i < 100; ++i) {
+        type("fjdk ");
+        chord("jk");
+        type("dfjk ");
+        chord("df");
+    }
+    run_trace();
+}
+
+TEST_F(Benchmark, key_overrides) {
+    for (int i = 0; i < 100; ++i) {
+        type("word ");
+        hold('^', "\b\b\b");
+        type("\b\b");
+    }
+    run_trace();
+}
+
+TEST_F(Benchmark, autocorrect) {
+    for (int i = 0; i < 40; ++i) {
+        type("becuase the lenght of the fitler intput ");
+    }
+    run_trace();
+}
@@ -0,0 +1,57 @@
+// Copyright 2026 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "quantum.h"
+#include "keymap_introspection.h"
+#include "combo_tables.h"
+
+combo_table_t test_combo_table = COMBO_TABLE_KEYMAP;
+
+static uint16_t const ef_combo[]  = {KC_E, KC_F, COMBO_END};
+static uint16_t const gh_combo[]  = {KC_G, KC_H, COMBO_END};
+static uint16_t const eg_combo[]  = {KC_E, KC_G, COMBO_END};
+static uint16_t const fh_combo[]  = {KC_F, KC_H, COMBO_END};
+static uint16_t const abc_combo[] = {KC_A, KC_B, KC_C, COMBO_END};
+static uint16_t const bcd_combo[] = {KC_B, KC_C, KC_D, COMBO_END};
+static uint16_t const cde_combo[] = {KC_C, KC_D, KC_E, COMBO_END};
+static uint16_t const def_combo[] = {KC_D, KC_E, KC_F, COMBO_END};
+static uint16_t const efg_combo[] = {KC_E, KC_F, KC_G, COMBO_END};
+
+// clang-format off
+static combo_t swapped_combos[] = {
+    COMBO(ef_combo, KC_X),
+    COMBO(gh_combo, KC_Y),
+    COMBO(eg_combo, KC_Z),
+    COMBO(fh_combo, KC_W)
+};
+
+static combo_t large_combos[] = {
+    COMBO(abc_combo, KC_1),
+    COMBO(bcd_combo, KC_2),
+    COMBO(cde_combo, KC_3),
+    COMBO(def_combo, KC_4),
+    COMBO(efg_combo, KC_5)
+};
+// clang-format on
+
+uint16_t combo_count(void) {
+    switch (test_combo_table) {
+        case COMBO_TABLE_SWAPPED:
+            return ARRAY_SIZE(swapped_combos);
+        case COMBO_TABLE_LARGE:
+            return ARRAY_SIZE(large_combos);
+        default:
+            return combo_count_raw();
+    }
+}
+
+combo_t *combo_get(uint16_t combo_idx) {
+    switch (test_combo_table) {
+        case COMBO_TABLE_SWAPPED:
+            return &swapped_combos[combo_idx];
+        case COMBO_TABLE_LARGE:
+            return &large_combos[combo_idx];
+        default:
+            return combo_get_raw(combo_idx);
+    }
+}
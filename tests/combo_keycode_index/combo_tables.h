@@ -0,0 +1,12 @@
+// Copyright 2026 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+typedef enum {
+    COMBO_TABLE_KEYMAP,  // key_combos of the keymap
+    COMBO_TABLE_SWAPPED, // as many combos as the keymap, on other keys
+    COMBO_TABLE_LARGE,   // more keys than the index has room for
+} combo_table_t;
+
+extern combo_table_t test_combo_table;
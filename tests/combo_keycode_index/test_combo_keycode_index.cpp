@@ -0,0 +1,126 @@
+// Copyright 2026 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "combo_tables.h"
+}
+
+using testing::_;
+using testing::InSequence;
+
+class ComboKeycodeIndex : public TestFixture {
+   protected:
+    void SetUp() override {
+        test_combo_table = COMBO_TABLE_KEYMAP;
+        combo_keycode_index_invalidate();
+    }
+
+    KeymapKey key_a{0, 0, 0, KC_A};
+    KeymapKey key_b{0, 1, 0, KC_B};
+    KeymapKey key_c{0, 2, 0, KC_C};
+    KeymapKey key_d{0, 3, 0, KC_D};
+    KeymapKey key_e{0, 4, 0, KC_E};
+    KeymapKey key_f{0, 5, 0, KC_F};
+    KeymapKey key_g{0, 6, 0, KC_G};
+    KeymapKey key_h{0, 7, 0, KC_H};
+
+    void set_all_keys() {
+        set_keymap({key_a, key_b, key_c, key_d, key_e, key_f, key_g, key_h});
+    }
+};
+
+TEST_F(ComboKeycodeIndex, combos_sharing_keys_trigger) {
+    TestDriver driver;
+    set_all_keys();
+
+    EXPECT_REPORT(driver, (KC_Y));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_combo({key_a, key_c});
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_Z));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_combo({key_b, key_c, key_d});
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ComboKeycodeIndex, lookup_keeps_combo_order) {
+    TestDriver driver;
+    set_all_keys();
+
+    // Two combos on the same keys, the later one wins like when all combos are scanned
+    EXPECT_REPORT(driver, (KC_W));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_combo({key_a, key_b});
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_W));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_combo({key_b, key_a});
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ComboKeycodeIndex, keys_outside_combos_pass_through) {
+    TestDriver driver;
+    set_all_keys();
+
+    EXPECT_REPORT(driver, (KC_E));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_e);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ComboKeycodeIndex, overflow_falls_back_to_scanning_all_combos) {
+    TestDriver driver;
+    set_all_keys();
+
+    // Fifteen keys don't fit into the index, the number of combos changed so it is rebuilt
+    test_combo_table = COMBO_TABLE_LARGE;
+
+    EXPECT_REPORT(driver, (KC_1));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_combo({key_a, key_b, key_c});
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_5));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_combo({key_e, key_f, key_g});
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ComboKeycodeIndex, invalidate_rebuilds_index) {
+    TestDriver driver;
+    set_all_keys();
+
+    // Build the index for the keymap's combos
+    EXPECT_REPORT(driver, (KC_Y));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_combo({key_a, key_c});
+    VERIFY_AND_CLEAR(driver);
+
+    // Same number of combos on other keys, only found after invalidating the index
+    test_combo_table = COMBO_TABLE_SWAPPED;
+    combo_keycode_index_invalidate();
+
+    EXPECT_REPORT(driver, (KC_X));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_combo({key_e, key_f});
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_W));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_combo({key_f, key_h});
+    VERIFY_AND_CLEAR(driver);
+
+    // The keymap's combos are no longer part of the index
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_a);
+    VERIFY_AND_CLEAR(driver);
+}
@@ -0,0 +1,17 @@
+// Copyright 2026 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "quantum.h"
+
+// Nine keys in four combos, the index has room for twelve
+uint16_t const ab_combo[]  = {KC_A, KC_B, COMBO_END};
+uint16_t const ac_combo[]  = {KC_A, KC_C, COMBO_END};
+uint16_t const bcd_combo[] = {KC_B, KC_C, KC_D, COMBO_END};
+
+// clang-format off
+combo_t key_combos[] = {
+    COMBO(ab_combo, KC_X),
+    COMBO(ac_combo, KC_Y),
+    COMBO(bcd_combo, KC_Z),
+    COMBO(ab_combo, KC_W)
+};
+// clang-format on
@@ -0,0 +1,11 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "test_common.h"
+
+#define EEPROM_SIZE 1024
+#define DYNAMIC_KEYMAP_CACHE_ENABLE
+// Only cache part of the layers, so both the cached and the EEPROM paths are covered
+#define DYNAMIC_KEYMAP_CACHE_LAYER_COUNT 2
@@ -0,0 +1,125 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "dynamic_keymap.h"
+#include "eeprom.h"
+}
+
+class DynamicKeymapCache : public TestFixture {
+   protected:
+    /* The keycode as stored in EEPROM, bypassing the cache */
+    uint16_t eeprom_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+        uint8_t *address = (uint8_t *)dynamic_keymap_key_to_eeprom_address(layer, row, column);
+        return (eeprom_read_byte(address) << 8) | eeprom_read_byte(address + 1);
+    }
+
+    /* Without an encoder map the macro buffer directly follows the keymap layers */
+    uint8_t *macro_eeprom_address(void) {
+        return (uint8_t *)dynamic_keymap_key_to_eeprom_address(0, 0, 0) + dynamic_keymap_get_layer_count() * MATRIX_ROWS * MATRIX_COLS * 2;
+    }
+
+    void expect_keymap_matches_eeprom(void) {
+        for (uint8_t layer = 0; layer < dynamic_keymap_get_layer_count(); layer++) {
+            for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+                for (uint8_t column = 0; column < MATRIX_COLS; column++) {
+                    EXPECT_EQ(dynamic_keymap_get_keycode(layer, row, column), eeprom_keycode(layer, row, column)) << "layer " << +layer << " row " << +row << " column " << +column;
+                }
+            }
+        }
+    }
+
+    void expect_macros_match_eeprom(void) {
+        uint16_t size = dynamic_keymap_macro_get_buffer_size();
+        uint8_t  buffer[size];
+        dynamic_keymap_macro_get_buffer(0, size, buffer);
+        for (uint16_t i = 0; i < size; i++) {
+            EXPECT_EQ(buffer[i], eeprom_read_byte(macro_eeprom_address() + i)) << "offset " << i;
+        }
+    }
+};
+
+TEST_F(DynamicKeymapCache, SetKeycodeWritesThrough) {
+    dynamic_keymap_reset();
+
+    /* Layer 0 is cached, layer 3 is read from EEPROM */
+    dynamic_keymap_set_keycode(0, 1, 2, KC_A);
+    dynamic_keymap_set_keycode(3, 2, 1, KC_B);
+
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 1, 2), KC_A);
+    EXPECT_EQ(dynamic_keymap_get_keycode(3, 2, 1), KC_B);
+    expect_keymap_matches_eeprom();
+}
+
+TEST_F(DynamicKeymapCache, BufferWritesThrough) {
+    uint16_t size = dynamic_keymap_get_layer_count() * MATRIX_ROWS * MATRIX_COLS * 2;
+    uint8_t  written[size];
+    uint8_t  read[size];
+
+    for (uint16_t i = 0; i < size; i++) {
+        written[i] = i * 7;
+    }
+    /* Split the write the way VIA does, across the cached and uncached layers */
+    for (uint16_t offset = 0; offset < size; offset += 28) {
+        dynamic_keymap_set_buffer(offset, MIN(28, size - offset), written + offset);
+    }
+
+    dynamic_keymap_get_buffer(0, size, read);
+    EXPECT_EQ(memcmp(read, written, size), 0);
+    EXPECT_EQ(dynamic_keymap_get_keycode(1, 0, 0), (written[MATRIX_ROWS * MATRIX_COLS * 2] << 8) | written[MATRIX_ROWS * MATRIX_COLS * 2 + 1]);
+    expect_keymap_matches_eeprom();
+}
+
+TEST_F(DynamicKeymapCache, MacroBufferWritesThrough) {
+    uint8_t macros[] = "hello\0world";
+
+    dynamic_keymap_macro_reset();
+    dynamic_keymap_macro_set_buffer(0, sizeof(macros), macros);
+
+    uint8_t read[sizeof(macros)];
+    dynamic_keymap_macro_get_buffer(0, sizeof(macros), read);
+    EXPECT_EQ(memcmp(read, macros, sizeof(macros)), 0);
+    expect_macros_match_eeprom();
+}
+
+TEST_F(DynamicKeymapCache, ResetWritesThrough) {
+    uint8_t macros[] = "hello";
+
+    dynamic_keymap_set_keycode(0, 0, 0, KC_A);
+    dynamic_keymap_set_keycode(3, 0, 0, KC_B);
+    dynamic_keymap_macro_set_buffer(0, sizeof(macros), macros);
+
+    dynamic_keymap_reset();
+    dynamic_keymap_macro_reset();
+
+    /* The test keymap only has layer 0, all other layers reset to KC_TRNS */
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_NO);
+    EXPECT_EQ(dynamic_keymap_get_keycode(1, 0, 0), KC_TRNS);
+    EXPECT_EQ(dynamic_keymap_get_keycode(3, 0, 0), KC_TRNS);
+    expect_keymap_matches_eeprom();
+
+    uint8_t read[sizeof(macros)];
+    dynamic_keymap_macro_get_buffer(0, sizeof(macros), read);
+    for (uint8_t i = 0; i < sizeof(macros); i++) {
+        EXPECT_EQ(read[i], 0);
+    }
+    expect_macros_match_eeprom();
+}
+
+TEST_F(DynamicKeymapCache, InitReloadsFromEeprom) {
+    dynamic_keymap_reset();
+
+    /* Write behind the cache's back, like an EEPROM erase does */
+    uint8_t *address = (uint8_t *)dynamic_keymap_key_to_eeprom_address(0, 3, 4);
+    eeprom_update_byte(address, KC_C >> 8);
+    eeprom_update_byte(address + 1, KC_C & 0xFF);
+    eeprom_update_byte(macro_eeprom_address(), 'x');
+
+    dynamic_keymap_cache_init();
+
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 3, 4), KC_C);
+    expect_keymap_matches_eeprom();
+    expect_macros_match_eeprom();
+}
@@ -0,0 +1,124 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+class LayerLookupCache : public TestFixture {};
+
+TEST_F(LayerLookupCache, FollowsLayerChanges) {
+    TestDriver driver;
+    KeymapKey  key_a     = KeymapKey{0, 0, 0, KC_A};
+    KeymapKey  key_b     = KeymapKey{1, 0, 0, KC_B};
+    KeymapKey  key_trans = KeymapKey{2, 0, 0, KC_TRNS};
+
+    set_keymap({key_a, key_b, key_trans});
+
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+    layer_on(1);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 1);
+    layer_on(2);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 1);
+    layer_off(1);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+    layer_clear();
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(LayerLookupCache, KeepsKeysAboveChangedLayers) {
+    TestDriver driver;
+    KeymapKey  key_a = KeymapKey{0, 0, 0, KC_A};
+    KeymapKey  key_b = KeymapKey{0, 1, 0, KC_B};
+    KeymapKey  key_c = KeymapKey{1, 1, 0, KC_C};
+    KeymapKey  key_d = KeymapKey{3, 0, 0, KC_D};
+
+    set_keymap({key_a, key_b, key_c, key_d, KeymapKey{1, 0, 0, KC_TRNS}, KeymapKey{3, 1, 0, KC_TRNS}});
+
+    layer_on(3);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 3);
+    EXPECT_EQ(layer_switch_get_layer(key_b.position), 0);
+
+    /* Layer 1 is below layer 3, the first key keeps its layer, the second one changes */
+    layer_on(1);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 3);
+    EXPECT_EQ(layer_switch_get_layer(key_b.position), 1);
+
+    layer_off(3);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+    EXPECT_EQ(layer_switch_get_layer(key_b.position), 1);
+
+    layer_clear();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(LayerLookupCache, FollowsDefaultLayerChanges) {
+    TestDriver driver;
+    KeymapKey  key_a = KeymapKey{0, 0, 0, KC_A};
+    KeymapKey  key_b = KeymapKey{2, 0, 0, KC_B};
+
+    set_keymap({key_a, key_b});
+
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+    default_layer_set(1 << 2);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 2);
+    default_layer_set(1 << 0);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(LayerLookupCache, FollowsKeymapChanges) {
+    TestDriver driver;
+    KeymapKey  key_a = KeymapKey{0, 0, 0, KC_A};
+
+    set_keymap({key_a, KeymapKey{1, 0, 0, KC_TRNS}});
+
+    layer_on(1);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+
+    set_keymap({key_a, KeymapKey{1, 0, 0, KC_B}});
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 1);
+
+    layer_clear();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(LayerLookupCache, SendsKeycodeOfActiveLayer) {
+    TestDriver driver;
+    InSequence s;
+    KeymapKey  key_layer = KeymapKey{0, 1, 0, MO(1)};
+    KeymapKey  key_a     = KeymapKey{0, 0, 0, KC_A};
+    KeymapKey  key_b     = KeymapKey{1, 0, 0, KC_B};
+
+    set_keymap({key_layer, key_a, key_b});
+
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_a);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_NO_REPORT(driver);
+    key_layer.press();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_B));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_b);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_NO_REPORT(driver);
+    key_layer.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_a);
+    VERIFY_AND_CLEAR(driver);
+}
@@ -0,0 +1,94 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "quantum.h"
+#include <lib/lib8tion/lib8tion.h>
+#include "test_rgb_matrix.h"
+
+extern const led_point_t k_rgb_matrix_center;
+
+uint32_t geometry_frames     = 0;
+uint32_t geometry_mismatches = 0;
+
+static RGB geometry_leds[RGB_MATRIX_LED_COUNT];
+
+/**
+ * @brief The color of LED `i` in the current frame, computed the way the effects did before the geometry tables.
+ */
+static HSV geometry_reference(uint8_t i) {
+    HSV     hsv  = rgb_matrix_config.hsv;
+    uint8_t time = scale16by8(g_rgb_timer, rgb_matrix_config.speed / 2);
+    int16_t dx   = g_led_config.point[i].x - k_rgb_matrix_center.x;
+    int16_t dy   = g_led_config.point[i].y - k_rgb_matrix_center.y;
+    uint8_t dist = sqrt16(dx * dx + dy * dy);
+
+    switch (rgb_matrix_get_mode()) {
+        case RGB_MATRIX_CYCLE_OUT_IN:
+            hsv.h = 3 * dist / 2 + time;
+            break;
+        case RGB_MATRIX_CYCLE_OUT_IN_DUAL:
+            dx    = (k_rgb_matrix_center.x / 2) - abs8(dx);
+            hsv.h = 3 * sqrt16(dx * dx + dy * dy) + time;
+            break;
+        case RGB_MATRIX_CYCLE_PINWHEEL:
+            hsv.h = atan2_8(dy, dx) + time;
+            break;
+        case RGB_MATRIX_CYCLE_SPIRAL:
+            hsv.h = dist - time - atan2_8(dy, dx);
+            break;
+        case RGB_MATRIX_BAND_PINWHEEL_SAT:
+            hsv.s = scale8(hsv.s - time - atan2_8(dy, dx) * 3, hsv.s);
+            break;
+        case RGB_MATRIX_BAND_PINWHEEL_VAL:
+            hsv.v = scale8(hsv.v - time - atan2_8(dy, dx) * 3, hsv.v);
+            break;
+        case RGB_MATRIX_BAND_SPIRAL_SAT:
+            hsv.s = scale8(hsv.s + dist - time - atan2_8(dy, dx), hsv.s);
+            break;
+        case RGB_MATRIX_BAND_SPIRAL_VAL:
+            hsv.v = scale8(hsv.v + dist - time - atan2_8(dy, dx), hsv.v);
+            break;
+        case RGB_MATRIX_SOLID_MULTISPLASH:
+            hsv.v = 0;
+            for (uint8_t j = 0; j < g_last_hit_tracker.count; j++) {
+                dx              = g_led_config.point[i].x - g_last_hit_tracker.x[j];
+                dy              = g_led_config.point[i].y - g_last_hit_tracker.y[j];
+                uint16_t tick   = scale16by8(g_last_hit_tracker.tick[j], qadd8(rgb_matrix_config.speed, 1));
+                uint16_t effect = tick - sqrt16(dx * dx + dy * dy);
+                if (effect > 255) effect = 255;
+                hsv.v = qadd8(hsv.v, 255 - effect);
+            }
+            hsv.v = scale8(hsv.v, rgb_matrix_config.hsv.v);
+            break;
+    }
+    return hsv;
+}
+
+/**
+ * @brief Halves the brightness like a current-limited keyboard does, so that effects bypassing the override show up as mismatches.
+ */
+RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
+    hsv.v /= 2;
+    return hsv_to_rgb(hsv);
+}
+
+void test_rgb_matrix_set_color(int index, uint8_t r, uint8_t g, uint8_t b) {
+    geometry_leds[index] = (RGB){.r = r, .g = g, .b = b};
+}
+
+void test_rgb_matrix_set_color_all(uint8_t r, uint8_t g, uint8_t b) {
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        geometry_leds[i] = (RGB){.r = r, .g = g, .b = b};
+    }
+}
+
+void test_rgb_matrix_flush(void) {
+    geometry_frames++;
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        HSV hsv = geometry_reference(i);
+        hsv.v /= 2;
+        RGB rgb = hsv_to_rgb(hsv);
+        if (rgb.r != geometry_leds[i].r || rgb.g != geometry_leds[i].g || rgb.b != geometry_leds[i].b) {
+            geometry_mismatches++;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keycode.h"
+#include "test_common.hpp"
+
+extern "C" {
+extern uint32_t geometry_frames;
+extern uint32_t geometry_mismatches;
+void            advance_time(uint32_t ms);
+}
+
+using testing::NiceMock;
+
+class RgbMatrixGeometry : public TestFixture {
+   protected:
+    void SetUp() override {
+        rgb_matrix_enable_noeeprom();
+    }
+
+    /**
+     * @brief Runs `mode` for a while and checks that every frame matches the colors computed from the LED positions.
+     */
+    void run_mode(uint8_t mode) {
+        NiceMock<TestDriver> driver;
+
+        rgb_matrix_mode_noeeprom(mode);
+        run_one_scan_loop();
+        geometry_frames     = 0;
+        geometry_mismatches = 0;
+        for (uint32_t time = 0; time < 2000; ++time) {
+            keyboard_task();
+            advance_time(1);
+        }
+        EXPECT_GT(geometry_frames, 0);
+        EXPECT_EQ(geometry_mismatches, 0);
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+};
+
+TEST_F(RgbMatrixGeometry, cycle_out_in) {
+    run_mode(RGB_MATRIX_CYCLE_OUT_IN);
+}
+
+TEST_F(RgbMatrixGeometry, cycle_out_in_dual) {
+    run_mode(RGB_MATRIX_CYCLE_OUT_IN_DUAL);
+}
+
+TEST_F(RgbMatrixGeometry, cycle_pinwheel) {
+    run_mode(RGB_MATRIX_CYCLE_PINWHEEL);
+}
+
+TEST_F(RgbMatrixGeometry, cycle_spiral) {
+    run_mode(RGB_MATRIX_CYCLE_SPIRAL);
+}
+
+TEST_F(RgbMatrixGeometry, band_pinwheel) {
+    run_mode(RGB_MATRIX_BAND_PINWHEEL_SAT);
+    run_mode(RGB_MATRIX_BAND_PINWHEEL_VAL);
+}
+
+TEST_F(RgbMatrixGeometry, band_spiral) {
+    run_mode(RGB_MATRIX_BAND_SPIRAL_SAT);
+    run_mode(RGB_MATRIX_BAND_SPIRAL_VAL);
+}
+
+TEST_F(RgbMatrixGeometry, multisplash_with_distance_cache) {
+    NiceMock<TestDriver> driver;
+    KeymapKey            keys[] = {KeymapKey(0, 0, 0, KC_A), KeymapKey(0, 9, 3, KC_B), KeymapKey(0, 4, 1, KC_C), KeymapKey(0, 7, 2, KC_D), KeymapKey(0, 2, 3, KC_E), KeymapKey(0, 5, 0, KC_F)};
+    for (auto& key : keys) {
+        add_key(key);
+    }
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_MULTISPLASH);
+    run_one_scan_loop();
+    geometry_frames     = 0;
+    geometry_mismatches = 0;
+    // More keys than LED_HITS_TO_REMEMBER, so cached distance rows get evicted while splashes are running.
+    for (int round = 0; round < 4; ++round) {
+        for (auto& key : keys) {
+            key.press();
+            for (int i = 0; i < 40; ++i) {
+                keyboard_task();
+                advance_time(1);
+            }
+            key.release();
+            for (int i = 0; i < 40; ++i) {
+                keyboard_task();
+                advance_time(1);
+            }
+        }
+    }
+    EXPECT_GT(geometry_frames, 0);
+    EXPECT_EQ(geometry_mismatches, 0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(RgbMatrixGeometry, layout_changed_after_init) {
+    led_point_t saved = g_led_config.point[0];
+
+    // Keyboards may move LEDs after rgb_matrix_init(), the effects pick that up when they start
+    g_led_config.point[0] = {.x = 200, .y = 60};
+    run_mode(RGB_MATRIX_CYCLE_OUT_IN);
+    run_mode(RGB_MATRIX_CYCLE_SPIRAL);
+
+    g_led_config.point[0] = saved;
+}
@@ -0,0 +1,21 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "quantum.h"
+#include "test_rgb_matrix.h"
+
+uint32_t governor_frames = 0;
+
+// Simulated cost of the driver: every 4th LED set takes 1ms, and sending a frame takes 4ms
+static uint8_t governor_set_count = 0;
+
+void test_rgb_matrix_set_color(int index, uint8_t r, uint8_t g, uint8_t b) {
+    if (++governor_set_count == 4) {
+        governor_set_count = 0;
+        advance_time(1);
+    }
+}
+
+void test_rgb_matrix_flush(void) {
+    governor_frames++;
+    advance_time(4);
+}
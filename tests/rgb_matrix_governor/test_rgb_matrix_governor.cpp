@@ -0,0 +1,63 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keycode.h"
+#include "test_common.hpp"
+
+extern "C" {
+extern uint32_t governor_frames;
+extern uint16_t g_rgb_led_process_limit;
+void            advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::NiceMock;
+
+class RgbMatrixGovernor : public TestFixture {
+   protected:
+    void SetUp() override {
+        rgb_matrix_enable_noeeprom();
+        rgb_matrix_mode_noeeprom(RGB_MATRIX_CYCLE_LEFT_RIGHT);
+    }
+
+    /**
+     * @brief Runs the keyboard for `ms` milliseconds, tapping `key` every 100ms if given, and returns the number of frames sent.
+     */
+    uint32_t run(uint32_t ms, KeymapKey* key = nullptr) {
+        uint32_t frames = governor_frames;
+        uint32_t start  = timer_read32();
+        uint32_t next   = start;
+        while (timer_elapsed32(start) < ms) {
+            if (key && timer_elapsed32(next) < UINT32_MAX / 2) {
+                key->press();
+                keyboard_task();
+                advance_time(30);
+                key->release();
+                next += 100;
+            }
+            keyboard_task();
+            advance_time(1);
+        }
+        return governor_frames - frames;
+    }
+};
+
+TEST_F(RgbMatrixGovernor, throttles_while_typing) {
+    NiceMock<TestDriver> driver;
+    KeymapKey            key(0, 0, 0, KC_A);
+    set_keymap({key});
+
+    uint32_t idle_frames = run(5000);
+    EXPECT_EQ(g_rgb_led_process_limit, RGB_MATRIX_LED_PROCESS_LIMIT);
+
+    uint32_t typing_frames = run(5000, &key);
+    EXPECT_LT(g_rgb_led_process_limit, RGB_MATRIX_LED_PROCESS_LIMIT);
+    EXPECT_LT(typing_frames * 2, idle_frames);
+
+    // Lighting returns to full speed once typing stops
+    run(2000);
+    EXPECT_EQ(g_rgb_led_process_limit, RGB_MATRIX_LED_PROCESS_LIMIT);
+    EXPECT_GT(run(5000) * 10, idle_frames * 9);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -0,0 +1,12 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "test_rgb_matrix_config.h"
+
+#define RGB_MATRIX_INCREMENTAL_RENDER
+#define RGB_MATRIX_KEYPRESSES
+#define ENABLE_RGB_MATRIX_GRADIENT_LEFT_RIGHT
+#define ENABLE_RGB_MATRIX_SOLID_REACTIVE_SIMPLE
+#define RGB_MATRIX_DEFAULT_MODE RGB_MATRIX_SOLID_COLOR
@@ -0,0 +1,33 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "quantum.h"
+#include "test_rgb_matrix.h"
+
+uint32_t incremental_sets    = 0;
+uint32_t incremental_flushes = 0;
+bool     incremental_set_led[RGB_MATRIX_LED_COUNT];
+RGB      incremental_leds[RGB_MATRIX_LED_COUNT];
+bool     incremental_indicator = false;
+
+void test_rgb_matrix_set_color(int index, uint8_t r, uint8_t g, uint8_t b) {
+    incremental_sets++;
+    incremental_set_led[index] = true;
+    incremental_leds[index]    = (RGB){.r = r, .g = g, .b = b};
+}
+
+void test_rgb_matrix_set_color_all(uint8_t r, uint8_t g, uint8_t b) {
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        test_rgb_matrix_set_color(i, r, g, b);
+    }
+}
+
+void test_rgb_matrix_flush(void) {
+    incremental_flushes++;
+}
+
+bool rgb_matrix_indicators_user(void) {
+    if (incremental_indicator) {
+        rgb_matrix_set_color(0, 255, 0, 0);
+    }
+    return true;
+}
@@ -0,0 +1,9 @@
+# Copyright 2023 QMK
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+RGB_MATRIX_ENABLE = yes
+RGB_MATRIX_DRIVER = custom
+
+INTROSPECTION_KEYMAP_C = incremental_keymap.c
+
+SRC += test_rgb_matrix.c
@@ -0,0 +1,134 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keycode.h"
+#include "test_common.hpp"
+
+extern "C" {
+extern uint32_t incremental_sets;
+extern uint32_t incremental_flushes;
+extern bool     incremental_set_led[RGB_MATRIX_LED_COUNT];
+extern RGB      incremental_leds[RGB_MATRIX_LED_COUNT];
+extern bool     incremental_indicator;
+void            advance_time(uint32_t ms);
+}
+
+using testing::NiceMock;
+
+class RgbMatrixIncremental : public TestFixture {
+   protected:
+    void SetUp() override {
+        incremental_indicator = false;
+        rgb_matrix_enable_noeeprom();
+        rgb_matrix_sethsv_noeeprom(HSV_BLUE);
+    }
+
+    /**
+     * @brief Runs the keyboard for `ms` milliseconds.
+     */
+    void run(uint32_t ms) {
+        for (uint32_t time = 0; time < ms; ++time) {
+            keyboard_task();
+            advance_time(1);
+        }
+    }
+
+    void clear_counters(void) {
+        incremental_sets    = 0;
+        incremental_flushes = 0;
+        memset(incremental_set_led, 0, sizeof(incremental_set_led));
+    }
+
+    void expect_led(uint8_t index, RGB rgb) {
+        EXPECT_EQ(incremental_leds[index].r, rgb.r) << "LED " << +index;
+        EXPECT_EQ(incremental_leds[index].g, rgb.g) << "LED " << +index;
+        EXPECT_EQ(incremental_leds[index].b, rgb.b) << "LED " << +index;
+    }
+
+    bool led_is_red(uint8_t index) {
+        return incremental_leds[index].r == 255 && incremental_leds[index].g == 0 && incremental_leds[index].b == 0;
+    }
+};
+
+TEST_F(RgbMatrixIncremental, static_effect_draws_once) {
+    NiceMock<TestDriver> driver;
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+    run(200);
+    clear_counters();
+    run(500);
+    EXPECT_EQ(incremental_sets, 0);
+    EXPECT_EQ(incremental_flushes, 0);
+
+    // A new color redraws every LED once
+    rgb_matrix_sethsv_noeeprom(HSV_GREEN);
+    run(500);
+    EXPECT_EQ(incremental_sets, RGB_MATRIX_LED_COUNT);
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        expect_led(i, hsv_to_rgb(rgb_matrix_config.hsv));
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(RgbMatrixIncremental, redraws_leds_drawn_over) {
+    NiceMock<TestDriver> driver;
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_GRADIENT_LEFT_RIGHT);
+    run(200);
+    RGB gradient = incremental_leds[5];
+
+    // Only the LED set from outside the effect is redrawn
+    rgb_matrix_set_color(5, 1, 2, 3);
+    clear_counters();
+    run(500);
+    EXPECT_EQ(incremental_sets, 1);
+    EXPECT_TRUE(incremental_set_led[5]);
+    expect_led(5, gradient);
+
+    // Indicators drawing every frame only cost the LEDs they draw over
+    incremental_indicator = true;
+    run(200);
+    clear_counters();
+    run(500);
+    EXPECT_GT(incremental_flushes, 0);
+    for (uint8_t i = 1; i < RGB_MATRIX_LED_COUNT; i++) {
+        EXPECT_FALSE(incremental_set_led[i]) << "LED " << +i;
+    }
+    EXPECT_TRUE(led_is_red(0));
+
+    incremental_indicator = false;
+    run(200);
+    EXPECT_FALSE(led_is_red(0));
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(RgbMatrixIncremental, reactive_redraws_fading_keys) {
+    NiceMock<TestDriver> driver;
+    KeymapKey            key(0, 2, 1, KC_A);
+    set_keymap({key});
+    uint8_t led = g_led_config.matrix_co[1][2];
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_REACTIVE_SIMPLE);
+    run(200);
+    RGB settled = incremental_leds[led];
+
+    clear_counters();
+    key.press();
+    run_one_scan_loop();
+    key.release();
+    run_one_scan_loop();
+    run(100);
+    EXPECT_GT(incremental_sets, 0);
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        EXPECT_EQ(incremental_set_led[i], i == led) << "LED " << +i;
+    }
+
+    // Once the key faded out it returns to the settled color and nothing is drawn anymore
+    run(5000);
+    expect_led(led, settled);
+    clear_counters();
+    run(500);
+    EXPECT_EQ(incremental_sets, 0);
+    EXPECT_EQ(incremental_flushes, 0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -0,0 +1,36 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "quantum.h"
+#include "test_rgb_matrix.h"
+
+_Static_assert(RGB_MATRIX_LED_COUNT == MATRIX_ROWS * MATRIX_COLS, "The test layout has one LED per matrix position");
+
+// One LED per matrix position, staggered so that no two rows share an x coordinate.
+#define LED_ROW(r) \
+    { (r) * MATRIX_COLS + 0, (r) * MATRIX_COLS + 1, (r) * MATRIX_COLS + 2, (r) * MATRIX_COLS + 3, (r) * MATRIX_COLS + 4, (r) * MATRIX_COLS + 5, (r) * MATRIX_COLS + 6, (r) * MATRIX_COLS + 7, (r) * MATRIX_COLS + 8, (r) * MATRIX_COLS + 9 }
+#define LED_POINTS(r) \
+    {0 + (r) * 5, (r) * 21}, {24 + (r) * 5, (r) * 21}, {48 + (r) * 5, (r) * 21}, {72 + (r) * 5, (r) * 21}, {96 + (r) * 5, (r) * 21}, {120 + (r) * 5, (r) * 21}, {144 + (r) * 5, (r) * 21}, {168 + (r) * 5, (r) * 21}, {192 + (r) * 5, (r) * 21}, {216 + (r) * 5, (r) * 21}
+#define LED_FLAGS 4, 4, 4, 4, 4, 4, 4, 4, 4, 4
+
+// clang-format off
+led_config_t g_led_config = {
+    { LED_ROW(0), LED_ROW(1), LED_ROW(2), LED_ROW(3) },
+    { LED_POINTS(0), LED_POINTS(1), LED_POINTS(2), LED_POINTS(3) },
+    { LED_FLAGS, LED_FLAGS, LED_FLAGS, LED_FLAGS }
+};
+// clang-format on
+
+__attribute__((weak)) void test_rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {}
+
+__attribute__((weak)) void test_rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {}
+
+__attribute__((weak)) void test_rgb_matrix_flush(void) {}
+
+static void test_rgb_init(void) {}
+
+const rgb_matrix_driver_t rgb_matrix_driver = {
+    .init          = test_rgb_init,
+    .set_color     = test_rgb_matrix_set_color,
+    .set_color_all = test_rgb_matrix_set_color_all,
+    .flush         = test_rgb_matrix_flush,
+};
@@ -0,0 +1,23 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The test RGB matrix driver in test_rgb_matrix.c hands every call to these,
+ * tests override the ones they need. The defaults discard the colors. */
+void test_rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
+void test_rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue);
+void test_rgb_matrix_flush(void);
+
+/* Lets the hooks above simulate the time a real driver would take. */
+void advance_time(uint32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,9 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "test_common.h"
+
+// The layout in test_rgb_matrix.c has one LED per matrix position
+#define RGB_MATRIX_LED_COUNT (MATRIX_ROWS * MATRIX_COLS)
@@ -27,6 +27,7 @@
 
 #include <ch.h>
 #include <hal.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "usb_main.h"
@@ -44,6 +45,10 @@
 #include "usb_descriptor.h"
 #include "usb_driver.h"
 
+#ifdef LATENCY_TRACE_ENABLE
+#    include "latency_trace.h"
+#endif
+
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
 
@@ -74,12 +79,15 @@ static void keyboard_idle_timer_cb(struct ch_virtual_timer *, void *arg);
 report_keyboard_t keyboard_report_sent = {{0}};
 report_mouse_t    mouse_report_sent    = {0};
 
-union {
+typedef union {
     uint8_t           report_id;
     report_keyboard_t keyboard;
 #ifdef EXTRAKEY_ENABLE
     report_extra_t extra;
 #endif
+#ifdef PROGRAMMABLE_BUTTON_ENABLE
+    report_programmable_button_t programmable_button;
+#endif
 #ifdef MOUSE_ENABLE
     report_mouse_t mouse;
 #endif
@@ -89,7 +97,9 @@ union {
 #ifdef JOYSTICK_ENABLE
     report_joystick_t joystick;
 #endif
-} universal_report_blank = {0};
+} usb_report_t;
+
+usb_report_t universal_report_blank = {0};
 
 /* ---------------------------------------------------------
  *            Descriptors and USB driver objects
@@ -129,16 +139,261 @@ static const USBDescriptor *usb_get_descriptor_cb(USBDriver *usbp, uint8_t dtype
         return &desc;
 }
 
+/* ---------------------------------------------------------
+ *                    HID report queues
+ * ---------------------------------------------------------
+ */
+
+/* Reports for a busy endpoint wait in a small per-endpoint queue instead of
+ * suspending the caller, and the IN notification callback starts the next
+ * one once the host has picked up the previous report. The slot at the head
+ * of a non-empty queue is the one being transmitted; the others may still be
+ * merged with newer reports of the same kind. Once all slots are taken the
+ * newest pending report of the same kind is overwritten, so a burst of more
+ * than USB_REPORT_QUEUE_SIZE - 1 unmergeable reports between two host polls
+ * loses the intermediate key transitions. */
+#ifndef USB_REPORT_QUEUE_SIZE
+#    define USB_REPORT_QUEUE_SIZE 8
+#endif
+
+typedef struct {
+    usb_report_t report;
+    uint8_t      report_id; /* kind of report, one of REPORT_ID_* */
+    uint8_t      offset;    /* first byte sent, boot protocol reports skip the report ID */
+    uint8_t      size;
+} usb_report_slot_t;
+
+typedef struct {
+    usb_report_slot_t slots[USB_REPORT_QUEUE_SIZE];
+    uint8_t           head;
+    uint8_t           count;
+} usb_report_queue_t;
+
+#ifndef KEYBOARD_SHARED_EP
+static usb_report_queue_t kbd_report_queue;
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+static usb_report_queue_t mouse_report_queue;
+#endif
+#ifdef SHARED_EP_ENABLE
+static usb_report_queue_t shared_report_queue;
+#endif
+#if defined(JOYSTICK_ENABLE) && !defined(JOYSTICK_SHARED_EP)
+static usb_report_queue_t joystick_report_queue;
+#endif
+#if defined(DIGITIZER_ENABLE) && !defined(DIGITIZER_SHARED_EP)
+static usb_report_queue_t digitizer_report_queue;
+#endif
+
+static usb_report_queue_t *const report_queues[MAX_ENDPOINTS + 1] = {
+#ifndef KEYBOARD_SHARED_EP
+    [KEYBOARD_IN_EPNUM] = &kbd_report_queue,
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+    [MOUSE_IN_EPNUM] = &mouse_report_queue,
+#endif
+#ifdef SHARED_EP_ENABLE
+    [SHARED_IN_EPNUM] = &shared_report_queue,
+#endif
+#if defined(JOYSTICK_ENABLE) && !defined(JOYSTICK_SHARED_EP)
+    [JOYSTICK_IN_EPNUM] = &joystick_report_queue,
+#endif
+#if defined(DIGITIZER_ENABLE) && !defined(DIGITIZER_SHARED_EP)
+    [DIGITIZER_IN_EPNUM] = &digitizer_report_queue,
+#endif
+};
+
+static inline usb_report_slot_t *report_queue_slot(usb_report_queue_t *queue, uint8_t index) {
+    return &queue->slots[(queue->head + index) % USB_REPORT_QUEUE_SIZE];
+}
+
+static inline bool report_keys_contain(const uint8_t *keys, uint8_t key) {
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (keys[i] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Checks that sending `next` in place of `pending` hides no edge from the
+ * host: nothing that changed from `prev` to `pending` may change back. */
+static bool keyboard_report_mergeable(const usb_report_slot_t *prev, const usb_report_slot_t *pending, const usb_report_slot_t *next) {
+    const report_keyboard_t *a = &prev->report.keyboard;
+    const report_keyboard_t *b = &pending->report.keyboard;
+    const report_keyboard_t *c = &next->report.keyboard;
+
+    if (prev->offset != next->offset || pending->offset != next->offset) {
+        return false;
+    }
+#ifdef NKRO_ENABLE
+    if (next->report_id == REPORT_ID_NKRO) {
+        if ((a->nkro.mods ^ b->nkro.mods) & (b->nkro.mods ^ c->nkro.mods)) {
+            return false;
+        }
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            if ((a->nkro.bits[i] ^ b->nkro.bits[i]) & (b->nkro.bits[i] ^ c->nkro.bits[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+#endif
+    if ((a->mods ^ b->mods) & (b->mods ^ c->mods)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        /* pressed in `pending` and released again */
+        if (b->keys[i] != KC_NO && !report_keys_contain(a->keys, b->keys[i]) && !report_keys_contain(c->keys, b->keys[i])) {
+            return false;
+        }
+        /* released in `pending` and pressed again */
+        if (a->keys[i] != KC_NO && !report_keys_contain(b->keys, a->keys[i]) && report_keys_contain(c->keys, a->keys[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef MOUSE_ENABLE
+/* Adds the movement of `next` to `pending` if the buttons did not change and the sums fit. */
+static bool mouse_report_merge(usb_report_slot_t *pending, const usb_report_slot_t *next) {
+    report_mouse_t       *a = &pending->report.mouse;
+    const report_mouse_t *b = &next->report.mouse;
+    int32_t               x = a->x + b->x;
+    int32_t               y = a->y + b->y;
+    int16_t               v = a->v + b->v;
+    int16_t               h = a->h + b->h;
+
+    if (a->buttons != b->buttons) {
+        return false;
+    }
+#    ifdef MOUSE_EXTENDED_REPORT
+    if (x < -32767 || x > 32767 || y < -32767 || y > 32767) {
+        return false;
+    }
+#    else
+    if (x < -127 || x > 127 || y < -127 || y > 127) {
+        return false;
+    }
+#    endif
+    if (v < -127 || v > 127 || h < -127 || h > 127) {
+        return false;
+    }
+    a->x = x;
+    a->y = y;
+    a->v = v;
+    a->h = h;
+#    ifdef MOUSE_EXTENDED_REPORT
+    a->boot_x = (x > 127) ? 127 : ((x < -127) ? -127 : x);
+    a->boot_y = (y > 127) ? 127 : ((y < -127) ? -127 : y);
+#    endif
+    return true;
+}
+#endif
+
+/* Queues `next` for the endpoint and starts the transfer if the endpoint is idle.
+ * Called in locked state. */
+static void report_queue_push_i(USBDriver *usbp, usbep_t ep, const usb_report_slot_t *next) {
+    usb_report_queue_t *queue   = report_queues[ep];
+    usb_report_slot_t  *pending = NULL;
+    uint8_t             index;
+
+    if (queue->count == 0) {
+        /* transmit from the slot, `next` lives on the caller's stack */
+        usb_report_slot_t *slot = report_queue_slot(queue, 0);
+        *slot                   = *next;
+        queue->count            = 1;
+        usbStartTransmitI(usbp, ep, (uint8_t *)&slot->report + slot->offset, slot->size);
+        return;
+    }
+
+    /* the latest report of the same kind that is not on the wire yet */
+    for (index = queue->count - 1; index > 0; index--) {
+        if (report_queue_slot(queue, index)->report_id == next->report_id) {
+            pending = report_queue_slot(queue, index);
+            break;
+        }
+    }
+
+    if (pending != NULL && index == queue->count - 1) {
+#ifdef MOUSE_ENABLE
+        if (next->report_id == REPORT_ID_MOUSE && mouse_report_merge(pending, next)) {
+            return;
+        }
+#endif
+        if (next->report_id == REPORT_ID_KEYBOARD || next->report_id == REPORT_ID_NKRO) {
+            for (uint8_t i = index; i-- > 0;) {
+                usb_report_slot_t *prev = report_queue_slot(queue, i);
+                if (prev->report_id == next->report_id) {
+                    if (keyboard_report_mergeable(prev, pending, next)) {
+                        *pending = *next;
+                        return;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (queue->count < USB_REPORT_QUEUE_SIZE) {
+        *report_queue_slot(queue, queue->count++) = *next;
+    } else if (pending != NULL) {
+        /* out of slots: the host at least gets the latest state, but the presses and
+         * releases only seen in the overwritten report are lost */
+        *pending = *next;
+    }
+}
+
 /*
- * USB notification callback that does nothing.  Needed to work around bugs in
- * some USB LLDs that fail to resume the waiting thread when the notification
- * callback pointer is NULL.
+ * Report IN notification callback (called from ISR, unlocked state), sends
+ * the next queued report.
  */
-static void dummy_usb_cb(USBDriver *usbp, usbep_t ep) {
-    (void)usbp;
-    (void)ep;
+static void report_in_cb(USBDriver *usbp, usbep_t ep) {
+    usb_report_queue_t *queue = report_queues[ep];
+
+    osalSysLockFromISR();
+    if (queue->count > 0) {
+        queue->head = (queue->head + 1) % USB_REPORT_QUEUE_SIZE;
+        queue->count--;
+    }
+    if (queue->count > 0) {
+        usb_report_slot_t *slot = report_queue_slot(queue, 0);
+        usbStartTransmitI(usbp, ep, (uint8_t *)&slot->report + slot->offset, slot->size);
+    }
+    osalSysUnlockFromISR();
 }
 
+/* Drops every queued report, called when the endpoints are (re)configured. */
+static void report_queues_reset_i(void) {
+    for (uint8_t ep = 0; ep <= MAX_ENDPOINTS; ep++) {
+        if (report_queues[ep] != NULL) {
+            report_queues[ep]->head  = 0;
+            report_queues[ep]->count = 0;
+        }
+    }
+}
+
+#ifdef LATENCY_TRACE_ENABLE
+/*
+ * Keyboard report IN notification callback, timestamps the completed transfer
+ * if it was a keyboard report. The shared endpoint also carries mouse and extra reports.
+ */
+static void keyboard_in_cb(USBDriver *usbp, usbep_t ep) {
+    usb_report_queue_t *queue = report_queues[ep];
+
+    if (queue->count > 0) {
+        uint8_t report_id = report_queue_slot(queue, 0)->report_id;
+        if (report_id == REPORT_ID_KEYBOARD || report_id == REPORT_ID_NKRO) {
+            latency_trace_usb_in_isr();
+        }
+    }
+    report_in_cb(usbp, ep);
+}
+#else
+#    define keyboard_in_cb report_in_cb
+#endif
+
 #ifndef KEYBOARD_SHARED_EP
 /* keyboard endpoint state structure */
 static USBInEndpointState kbd_ep_state;
@@ -146,7 +401,7 @@ static USBInEndpointState kbd_ep_state;
 static const USBEndpointConfig kbd_ep_config = {
     USB_EP_MODE_TYPE_INTR,  /* Interrupt EP */
     NULL,                   /* SETUP packet notification callback */
-    dummy_usb_cb,           /* IN notification callback */
+    keyboard_in_cb,         /* IN notification callback */
     NULL,                   /* OUT notification callback */
     KEYBOARD_EPSIZE,        /* IN maximum packet size */
     0,                      /* OUT maximum packet size */
@@ -164,7 +419,7 @@ static USBInEndpointState mouse_ep_state;
 static const USBEndpointConfig mouse_ep_config = {
     USB_EP_MODE_TYPE_INTR,  /* Interrupt EP */
     NULL,                   /* SETUP packet notification callback */
-    dummy_usb_cb,           /* IN notification callback */
+    report_in_cb,           /* IN notification callback */
     NULL,                   /* OUT notification callback */
     MOUSE_EPSIZE,           /* IN maximum packet size */
     0,                      /* OUT maximum packet size */
@@ -182,7 +437,7 @@ static USBInEndpointState shared_ep_state;
 static const USBEndpointConfig shared_ep_config = {
     USB_EP_MODE_TYPE_INTR,  /* Interrupt EP */
     NULL,                   /* SETUP packet notification callback */
-    dummy_usb_cb,           /* IN notification callback */
+    keyboard_in_cb,         /* IN notification callback */
     NULL,                   /* OUT notification callback */
     SHARED_EPSIZE,          /* IN maximum packet size */
     0,                      /* OUT maximum packet size */
@@ -200,7 +455,7 @@ static USBInEndpointState joystick_ep_state;
 static const USBEndpointConfig joystick_ep_config = {
     USB_EP_MODE_TYPE_INTR,  /* Interrupt EP */
     NULL,                   /* SETUP packet notification callback */
-    dummy_usb_cb,           /* IN notification callback */
+    report_in_cb,           /* IN notification callback */
     NULL,                   /* OUT notification callback */
     JOYSTICK_EPSIZE,        /* IN maximum packet size */
     0,                      /* OUT maximum packet size */
@@ -218,7 +473,7 @@ static USBInEndpointState digitizer_ep_state;
 static const USBEndpointConfig digitizer_ep_config = {
     USB_EP_MODE_TYPE_INTR,  /* Interrupt EP */
     NULL,                   /* SETUP packet notification callback */
-    dummy_usb_cb,           /* IN notification callback */
+    report_in_cb,           /* IN notification callback */
     NULL,                   /* OUT notification callback */
     DIGITIZER_EPSIZE,       /* IN maximum packet size */
     0,                      /* OUT maximum packet size */
@@ -506,6 +761,7 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
 
         case USB_EVENT_CONFIGURED:
             osalSysLockFromISR();
+            report_queues_reset_i();
             /* Enable the endpoints specified into the configuration. */
 #ifndef KEYBOARD_SHARED_EP
             usbInitEndpointI(usbp, KEYBOARD_IN_EPNUM, &kbd_ep_config);
@@ -842,8 +1098,10 @@ static void keyboard_idle_timer_cb(struct ch_virtual_timer *timer, void *arg) {
     if (keyboard_idle && keyboard_protocol) {
 #endif /* NKRO_ENABLE */
         /* TODO: are we sure we want the KBD_ENDPOINT? */
-        if (!usbGetTransmitStatusI(usbp, KEYBOARD_IN_EPNUM)) {
-            usbStartTransmitI(usbp, KEYBOARD_IN_EPNUM, (uint8_t *)&keyboard_report_sent, KEYBOARD_EPSIZE);
+        if (report_queues[KEYBOARD_IN_EPNUM]->count == 0) {
+            usb_report_slot_t slot = {.report_id = REPORT_ID_KEYBOARD, .offset = 0, .size = KEYBOARD_EPSIZE};
+            slot.report.keyboard   = keyboard_report_sent;
+            report_queue_push_i(usbp, KEYBOARD_IN_EPNUM, &slot);
         }
         /* rearm the timer */
         chVTSetI(&keyboard_idle_timer, 4 * TIME_MS2I(keyboard_idle), keyboard_idle_timer_cb, (void *)usbp);
@@ -859,45 +1117,41 @@ uint8_t keyboard_leds(void) {
     return keyboard_led_state;
 }
 
-void send_report(uint8_t endpoint, void *report, size_t size) {
+/* queue a report IN, never waits for the endpoint
+ * not callable from ISR or locked state */
+static void send_report(uint8_t endpoint, uint8_t report_id, const void *report, uint8_t offset, uint8_t size) {
+    usb_report_slot_t slot = {.report_id = report_id, .offset = offset, .size = size};
+    memcpy(&slot.report, report, offset + size);
+
     osalSysLock();
     if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
         osalSysUnlock();
         return;
     }
-
-    if (usbGetTransmitStatusI(&USB_DRIVER, endpoint)) {
-        /* Need to either suspend, or loop and call unlock/lock during
-         * every iteration - otherwise the system will remain locked,
-         * no interrupts served, so USB not going through as well.
-         * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[endpoint]->in_state->thread, TIME_MS2I(10)) == MSG_TIMEOUT) {
-            osalSysUnlock();
-            return;
-        }
-    }
-    usbStartTransmitI(&USB_DRIVER, endpoint, report, size);
+    report_queue_push_i(&USB_DRIVER, endpoint, &slot);
     osalSysUnlock();
 }
 
 /* prepare and start sending a report IN
  * not callable from ISR or locked state */
 void send_keyboard(report_keyboard_t *report) {
-    uint8_t ep   = KEYBOARD_IN_EPNUM;
-    size_t  size = KEYBOARD_REPORT_SIZE;
+    uint8_t ep        = KEYBOARD_IN_EPNUM;
+    uint8_t report_id = REPORT_ID_KEYBOARD;
+    size_t  size      = KEYBOARD_REPORT_SIZE;
 
     /* If we're in Boot Protocol, don't send any report ID or other funky fields */
     if (!keyboard_protocol) {
-        send_report(ep, &report->mods, 8);
+        send_report(ep, report_id, report, offsetof(report_keyboard_t, mods), 8);
     } else {
 #ifdef NKRO_ENABLE
         if (keymap_config.nkro) {
-            ep   = SHARED_IN_EPNUM;
-            size = sizeof(struct nkro_report);
+            ep        = SHARED_IN_EPNUM;
+            report_id = REPORT_ID_NKRO;
+            size      = sizeof(struct nkro_report);
         }
 #endif
 
-        send_report(ep, report, size);
+        send_report(ep, report_id, report, 0, size);
     }
 
     keyboard_report_sent = *report;
@@ -910,7 +1164,7 @@ void send_keyboard(report_keyboard_t *report) {
 
 void send_mouse(report_mouse_t *report) {
 #ifdef MOUSE_ENABLE
-    send_report(MOUSE_IN_EPNUM, report, sizeof(report_mouse_t));
+    send_report(MOUSE_IN_EPNUM, REPORT_ID_MOUSE, report, 0, sizeof(report_mouse_t));
     mouse_report_sent = *report;
 #endif
 }
@@ -922,25 +1176,25 @@ void send_mouse(report_mouse_t *report) {
 
 void send_extra(report_extra_t *report) {
 #ifdef EXTRAKEY_ENABLE
-    send_report(SHARED_IN_EPNUM, report, sizeof(report_extra_t));
+    send_report(SHARED_IN_EPNUM, report->report_id, report, 0, sizeof(report_extra_t));
 #endif
 }
 
 void send_programmable_button(report_programmable_button_t *report) {
 #ifdef PROGRAMMABLE_BUTTON_ENABLE
-    send_report(SHARED_IN_EPNUM, report, sizeof(report_programmable_button_t));
+    send_report(SHARED_IN_EPNUM, REPORT_ID_PROGRAMMABLE_BUTTON, report, 0, sizeof(report_programmable_button_t));
 #endif
 }
 
 void send_joystick(report_joystick_t *report) {
 #ifdef JOYSTICK_ENABLE
-    send_report(JOYSTICK_IN_EPNUM, report, sizeof(report_joystick_t));
+    send_report(JOYSTICK_IN_EPNUM, REPORT_ID_JOYSTICK, report, 0, sizeof(report_joystick_t));
 #endif
 }
 
 void send_digitizer(report_digitizer_t *report) {
 #ifdef DIGITIZER_ENABLE
-    send_report(DIGITIZER_IN_EPNUM, report, sizeof(report_digitizer_t));
+    send_report(DIGITIZER_IN_EPNUM, REPORT_ID_DIGITIZER, report, 0, sizeof(report_digitizer_t));
 #endif
 }
 
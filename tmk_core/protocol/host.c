@@ -40,6 +40,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 extern keymap_config_t keymap_config;
 #endif
 
+#ifdef LATENCY_TRACE_ENABLE
+#    include "latency_trace.h"
+#endif
+
 static host_driver_t *driver;
 static uint16_t       last_system_usage   = 0;
 static uint16_t       last_consumer_usage = 0;
@@ -71,15 +75,11 @@ led_t host_keyboard_led_state(void) {
     return (led_t)host_keyboard_leds();
 }
 
-extern void uart_send_report_func(void);        
-extern void uart_send_mouse_report(void);       
-extern void uart_send_consumer_report(void);    
-extern void uart_send_system_report(void);      
-
 /* send report */
 void host_keyboard_send(report_keyboard_t *report) {
-    
-    uart_send_report_func(); 
+#ifdef LATENCY_TRACE_ENABLE
+    latency_trace_report();
+#endif
 
 #ifdef BLUETOOTH_ENABLE
     if (where_to_send() == OUTPUT_BLUETOOTH) {
@@ -115,9 +115,6 @@ void host_keyboard_send(report_keyboard_t *report) {
 }
 
 void host_mouse_send(report_mouse_t *report) {
-     
-    uart_send_mouse_report();
-
 #ifdef BLUETOOTH_ENABLE
     if (where_to_send() == OUTPUT_BLUETOOTH) {
         bluetooth_send_mouse(report);
@@ -141,8 +138,6 @@ void host_system_send(uint16_t usage) {
     if (usage == last_system_usage) return;
     last_system_usage = usage;
 
-    uart_send_system_report();
-
     if (!driver) return;
 
     report_extra_t report = {
@@ -155,8 +150,6 @@ void host_system_send(uint16_t usage) {
 void host_consumer_send(uint16_t usage) {
     if (usage == last_consumer_usage) return;
     last_consumer_usage = usage;
-    
-    uart_send_consumer_report(); 
 
 #ifdef BLUETOOTH_ENABLE
     if (where_to_send() == OUTPUT_BLUETOOTH) {